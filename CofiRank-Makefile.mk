@@ -43,9 +43,54 @@ build: .build-pre .build-impl .build-post
 .build-pre:
 # Add your pre 'build' code here...
 
-.build-post:
+.build-post: .build-recommend
 # Add your post 'build' code here...
 
+# The command line tool for recommendations, src/cofi/cfbmrm-recommend.cpp.
+# It links the objects of the configuration, but with its own main().
+RECOMMEND_Debug=dist/cofirank-recommend-debug
+RECOMMEND_Deploy=dist/cofirank-recommend-deploy
+
+.build-recommend:
+	${MAKE} -f nbproject/Makefile-${CONF}.mk CONF=${CONF} .build-recommend-conf
+
+.build-recommend-conf:
+	${MKDIR} -p ${OBJECTDIR}/src/cofi
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/cofi/cfbmrm-recommend.o src/cofi/cfbmrm-recommend.cpp
+	${MKDIR} -p dist
+	${LINK.cc} -o ${RECOMMEND_${CONF}} $(filter-out ${OBJECTDIR}/src/cofi/cfbmrm-train.o,${OBJECTFILES}) ${OBJECTDIR}/src/cofi/cfbmrm-recommend.o ${LDLIBSOPTIONS}
+
+
+# Benchmark drivers, bench/<name>.cpp. Like the recommender, each links the
+# objects of the configuration with its own main(), and with the helpers of
+# bench/benchutils.cpp. "make bench" builds and runs them with their default
+# sizes.
+BENCHMARKS=svmlightloaderbench itemindexbench ndcglossbench solverbench ratingmatrixbench moviephasebench
+
+# Phony, as there is a directory of the same name
+.PHONY: bench
+bench: build
+	${MAKE} -f nbproject/Makefile-${CONF}.mk CONF=${CONF} DRIVERDIR=bench DRIVERS="${BENCHMARKS}" DRIVERUTILS=benchutils .drivers-conf
+
+.drivers-conf:
+	${MKDIR} -p ${OBJECTDIR}/${DRIVERDIR} dist/${DRIVERDIR}
+	$(if ${DRIVERUTILS},$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/${DRIVERDIR}/${DRIVERUTILS}.o ${DRIVERDIR}/${DRIVERUTILS}.cpp)
+	for d in ${DRIVERS}; do \
+	    $(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/${DRIVERDIR}/$$d.o ${DRIVERDIR}/$$d.cpp && \
+	    ${LINK.cc} -o dist/${DRIVERDIR}/$$d-${CONF} $(filter-out ${OBJECTDIR}/src/cofi/cfbmrm-train.o,${OBJECTFILES}) $(if ${DRIVERUTILS},${OBJECTDIR}/${DRIVERDIR}/${DRIVERUTILS}.o) ${OBJECTDIR}/${DRIVERDIR}/$$d.o ${LDLIBSOPTIONS} && \
+	    echo "=> dist/${DRIVERDIR}/$$d-${CONF}" && dist/${DRIVERDIR}/$$d-${CONF} || exit 1; \
+	done
+
+
+# Test drivers, tests/<name>.cpp, built like the benchmark drivers with the
+# helpers of tests/testutils.cpp. "make test" runs them and fails if one of
+# them returns nonzero.
+TESTS=truncatedassignmenttest preferencerankingtest leastsquaretest daifletcherpgmtest
+
+.PHONY: test
+test: build
+	${MAKE} -f nbproject/Makefile-${CONF}.mk CONF=${CONF} DRIVERDIR=tests DRIVERS="${TESTS}" DRIVERUTILS=testutils .drivers-conf
+
 
 # clean
 clean: .clean-pre .clean-impl .clean-post
@@ -55,6 +100,7 @@ clean: .clean-pre .clean-impl .clean-post
 
 .clean-post:
 # Add your post 'clean' code here...
+	${RM} ${RECOMMEND_${CONF}}
 
 
 # clobber
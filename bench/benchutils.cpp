@@ -0,0 +1,77 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "benchutils.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "core/cofiexception.hpp"
+#include "utils/configuration.hpp"
+
+
+void cofi::bench::writeRatings(const std::string& filename, const size_t rows, const size_t perRow, const size_t cols) {
+    std::ofstream f(filename.c_str());
+    for (size_t i = 0; i < rows; ++i) {
+        std::set<size_t> items;
+        while (items.size() < perRow) {
+            items.insert(1 + rand() % cols);
+        }
+        for (std::set<size_t>::const_iterator it = items.begin(); it != items.end(); ++it) {
+            f << *it << ":" << (1 + rand() % 5) << " ";
+        }
+        f << "\n";
+    }
+}
+
+
+int cofi::bench::forEachLoss(LossRun& r, const std::string& configFile, const std::string& trainFile, const std::string& testFile) {
+    std::ofstream log("/dev/null");
+    std::streambuf* clog = std::clog.rdbuf(log.rdbuf());
+    int result = 0;
+    const char* losses[] = {"REGRESSION", "ORDINAL", "NDCG"};
+    for (size_t l = 0; l < 3; ++l) {
+        std::cout.flush();
+        const pid_t child = fork();
+        if (child == 0) {
+            int status = 1;
+            try {
+                Configuration& conf = Configuration::getInstance();
+                conf.readFromFile(configFile);
+                conf.setString("cofibmrm.DtrainFile", trainFile);
+                if (!testFile.empty()) {
+                    conf.setString("cofibmrm.DtestFile", testFile);
+                }
+                conf.setString("cofi.loss", losses[l]);
+                status = r.run(losses[l]);
+            } catch (cofi::CoFiException& e) {
+                std::cout << "ERROR: " << e.describe() << std::endl;
+            }
+            std::cout.flush();
+            _exit(status);
+        }
+        int status = 0;
+        if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            result = 1;
+        }
+    }
+    std::clog.rdbuf(clog);
+    return result;
+}
@@ -0,0 +1,69 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _BENCHUTILS_HPP_
+#define _BENCHUTILS_HPP_
+
+#include <string>
+
+namespace cofi {
+
+    /**
+     * Helpers shared by the benchmark drivers in bench/.
+     */
+    namespace bench {
+
+        /**
+         * Writes a random SVMLight file of rows users with perRow distinct
+         * items each out of 1 ... cols, rated 1 ... 5. Draws from rand(), so
+         * the caller seeds it.
+         */
+        void writeRatings(const std::string& filename, const size_t rows, const size_t perRow, const size_t cols);
+
+
+        /**
+         * A benchmark run with one loss, see forEachLoss().
+         */
+        class LossRun {
+        public:
+
+
+            virtual ~LossRun(void) {
+            }
+
+
+            /**
+             * Runs the benchmark. cofi.loss is set to loss already.
+             *
+             * @return 0 on success.
+             */
+            virtual int run(const std::string& loss) = 0;
+        };
+
+
+        /**
+         * Calls r.run() for the losses REGRESSION, ORDINAL and NDCG, each in
+         * a child process of its own, as the loss function factory reads
+         * cofi.loss only once. Each child reads configFile and sets the
+         * training and, unless empty, the test file. std::clog is discarded
+         * meanwhile.
+         *
+         * @return 0 if all runs succeeded.
+         */
+        int forEachLoss(LossRun& r, const std::string& configFile, const std::string& trainFile, const std::string& testFile);
+    }
+}
+#endif /* _BENCHUTILS_HPP_ */
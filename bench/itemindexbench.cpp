@@ -0,0 +1,143 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Measures recall against latency of the ItemIndex.
+ *
+ * Usage: itemindexbench [ITEMS [USERS [DIM [K]]]]
+ *
+ * Draws random factors for ITEMS items and USERS users and finds the top K
+ * items of each user exhaustively. Then it builds indices with several
+ * numbers of lists and searches each with several numbers of probes,
+ * including the default cofi.storeF.index.probes of 8, printing the recall
+ * of the exact top K and the time per user. Searching all lists must find
+ * the exact top K.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "core/types.hpp"
+#include "cofi/itemindex.hpp"
+#include "cofi/recommender.hpp"
+#include "utils/timer.hpp"
+
+namespace {
+
+    Real random(void) {
+        return 2.0 * rand() / RAND_MAX - 1.0;
+    }
+
+
+    void randomMatrix(const size_t rows, const size_t cols, cofi::MType& m) {
+        m.resize(rows, cols, false);
+        for (size_t i = 0; i < rows; ++i) {
+            // Varying norms, as in trained factors
+            const Real scale = 0.5 + rand() / (Real) RAND_MAX;
+            for (size_t j = 0; j < cols; ++j) {
+                m(i, j) = scale * random();
+            }
+        }
+    }
+
+
+    void exhaustive(const cofi::MType& M, const Real* u, const size_t k, std::vector<cofi::Recommendation>& result) {
+        result.resize(M.size1());
+        for (size_t i = 0; i < M.size1(); ++i) {
+            Real score = 0;
+            for (size_t j = 0; j < M.size2(); ++j) {
+                score += u[j] * M(i, j);
+            }
+            result[i].item = i;
+            result[i].score = score;
+        }
+        const size_t n = std::min(k, result.size());
+        std::partial_sort(result.begin(), result.begin() + n, result.end(), cofi::BetterRecommendation());
+        result.resize(n);
+    }
+
+
+    size_t hits(const std::vector<cofi::Recommendation>& exact, const std::vector<cofi::Recommendation>& found) {
+        size_t n = 0;
+        for (size_t i = 0; i < found.size(); ++i) {
+            for (size_t j = 0; j < exact.size(); ++j) {
+                if (found[i].item == exact[j].item) {
+                    ++n;
+                    break;
+                }
+            }
+        }
+        return n;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nItems = argc > 1 ? atoi(argv[1]) : 20000;
+    const size_t nUsers = argc > 2 ? atoi(argv[2]) : 1000;
+    const size_t dim = argc > 3 ? atoi(argv[3]) : 10;
+    const size_t k = argc > 4 ? atoi(argv[4]) : 10;
+
+    srand(1);
+    cofi::MType M;
+    randomMatrix(nItems, dim, M);
+    cofi::MType U;
+    randomMatrix(nUsers, dim, U);
+    std::vector<Real> u(dim);
+    const std::vector<cofi::itemid> excluded;
+
+    std::vector<std::vector<cofi::Recommendation> > exact(nUsers);
+    double start = WallClock();
+    for (size_t user = 0; user < nUsers; ++user) {
+        std::copy(ublas::row(U, user).begin(), ublas::row(U, user).end(), u.begin());
+        exhaustive(M, &u[0], k, exact[user]);
+    }
+    std::cout << nItems << " items, " << nUsers << " users, " << dim << " dimensions, top " << k << std::endl;
+    std::cout << "exhaustive: " << 1e6 * (WallClock() - start) / nUsers << "us per user" << std::endl;
+
+    int result = 0;
+    const size_t lists[] = {16, 64, 256};
+    const size_t probes[] = {1, 2, 4, 8, 16, 32, 256};
+    cofi::ItemIndex::Workspace ws;
+    std::vector<cofi::Recommendation> found;
+    for (size_t l = 0; l < sizeof (lists) / sizeof (lists[0]); ++l) {
+        start = WallClock();
+        const cofi::ItemIndex index(M, lists[l], cofi::ItemIndex::DEFAULT_ITERATIONS, 1);
+        std::cout << lists[l] << " lists, built in " << WallClock() - start << "s" << std::endl;
+        for (size_t p = 0; p < sizeof (probes) / sizeof (probes[0]) && probes[p] <= lists[l]; ++p) {
+            size_t nHits = 0;
+            size_t nExact = 0;
+            start = WallClock();
+            for (size_t user = 0; user < nUsers; ++user) {
+                std::copy(ublas::row(U, user).begin(), ublas::row(U, user).end(), u.begin());
+                index.search(&u[0], k, probes[p], excluded, found, ws);
+                nHits += hits(exact[user], found);
+                nExact += exact[user].size();
+            }
+            const double time = WallClock() - start;
+            const double recall = nHits / (double) nExact;
+            std::cout << "  " << probes[p] << " probes: recall " << recall << ", "
+                    << 1e6 * time / nUsers << "us per user" << std::endl;
+            if (probes[p] == lists[l] && nHits != nExact) {
+                std::cout << "ERROR: searching all lists misses items of the exact top " << k << std::endl;
+                result = 1;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,129 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Compares the item-major movie phase gradient with the scatter into
+ * per-thread buffers.
+ *
+ * Usage: moviephasebench [USERS [ITEMS [RATINGS_PER_USER [THREADS [REPEATS [CONFIG]]]]]]
+ *
+ * Writes a random training file and loads it with the options of CONFIG, by
+ * default config/default.cfg. For each loss and for 1, 2, 4, ... THREADS
+ * threads, it times REPEATS evaluations of the loss and gradient of the
+ * movie phase with cofi.moviephase.itemMajor 0 and 1. Both must agree: to the
+ * bit with one thread, as they sum the users in the same order, and up to
+ * rounding otherwise.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "benchutils.hpp"
+#include "core/types.hpp"
+#include "cofi/problem.hpp"
+#include "loss/moviephaselossfunction.hpp"
+#include "utils/configuration.hpp"
+#include "utils/timer.hpp"
+
+namespace {
+
+    /**
+     * Times repeats evaluations of the movie phase loss and gradient.
+     *
+     * @return the time of one evaluation.
+     */
+    double time(cofi::Problem& p, const bool itemMajor, const size_t repeats, Real& loss, cofi::MType& grad) {
+        Configuration::getInstance().setInt("cofi.moviephase.itemMajor", itemMajor ? 1 : 0);
+        cofi::MoviePhaseLossFunction m(p);
+        const double start = WallClock();
+        for (size_t k = 0; k < repeats; ++k) {
+            m.ComputeLossGradient(p.getM(), loss, grad);
+        }
+        return (WallClock() - start) / repeats;
+    }
+
+
+    /**
+     * Times both modes with the given loss.
+     */
+    class MoviePhaseRun : public cofi::bench::LossRun {
+    public:
+
+
+        MoviePhaseRun(const size_t maxThreads, const size_t repeats) : maxThreads(maxThreads), repeats(repeats) {
+        }
+
+
+        /**
+         * @return 0 if both modes agree.
+         */
+        int run(const std::string& loss) {
+            Configuration& conf = Configuration::getInstance();
+            // Problem builds the column index of D only for the item-major mode
+            conf.setInt("cofi.moviephase.itemMajor", 1);
+            srand(2);
+            cofi::Problem p;
+            int result = 0;
+            for (size_t t = 1; t <= maxThreads; t *= 2) {
+                conf.setInt("cofi.threads", t);
+                Real scatterLoss = 0;
+                cofi::MType scatterGrad(p.getM().size1(), p.getM().size2());
+                const double scatter = time(p, false, repeats, scatterLoss, scatterGrad);
+                Real itemMajorLoss = 0;
+                cofi::MType itemMajorGrad(p.getM().size1(), p.getM().size2());
+                const double itemMajor = time(p, true, repeats, itemMajorLoss, itemMajorGrad);
+                std::cout << loss << ", " << t << " threads: scatter " << scatter << "s, item-major " << itemMajor
+                        << "s (" << scatter / itemMajor << "x)" << std::endl;
+
+                const Real tolerance = t == 1 ? 0 : 1e-9;
+                const Real distance = norm_frobenius(scatterGrad - itemMajorGrad);
+                if (!(fabs(scatterLoss - itemMajorLoss) <= tolerance * scatterLoss)
+                        || !(distance <= tolerance * norm_frobenius(scatterGrad))) {
+                    std::cout << "ERROR: item-major loss " << itemMajorLoss << " instead of " << scatterLoss
+                            << ", distance of the gradients " << distance << std::endl;
+                    result = 1;
+                }
+            }
+            return result;
+        }
+
+    private:
+        const size_t maxThreads;
+        const size_t repeats;
+    };
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nUsers = argc > 1 ? atoi(argv[1]) : 2000;
+    const size_t nItems = argc > 2 ? atoi(argv[2]) : 1000;
+    const size_t perUser = argc > 3 ? atoi(argv[3]) : 50;
+    const size_t maxThreads = argc > 4 ? atoi(argv[4]) : 4;
+    const size_t repeats = argc > 5 ? atoi(argv[5]) : 5;
+    const std::string configFile = argc > 6 ? argv[6] : "config/default.cfg";
+    const std::string trainFile = "/tmp/cofirank-moviephasebench-train.lsvm";
+
+    srand(1);
+    cofi::bench::writeRatings(trainFile, nUsers, perUser, nItems);
+    std::cout << nUsers << " users, " << nItems << " items, " << perUser << " ratings per user" << std::endl;
+
+    MoviePhaseRun r(maxThreads, repeats);
+    const int result = cofi::bench::forEachLoss(r, configFile, trainFile, "");
+    remove(trainFile.c_str());
+    return result;
+}
@@ -0,0 +1,336 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Compares NDCGDomainModel::ComputeLossPartGradient with the implementation
+ * it replaced, which computed 2^y - 1 and log2(i + 2) with pow() and log2()
+ * for every entry, allocated the permutations on every call and, for
+ * c_exponent > 0, the n rows of the cost matrix of lap() as well. Its
+ * TruncatedAssignment accessed the vectors through their operators.
+ *
+ * Usage: ndcglossbench [DIM [TRUNCATION]]
+ *
+ * Runs both on random users with n = 100 and 1000 ratings for the default
+ * c_exponent of -0.25, which uses TruncatedAssignment, and with n = 100 for
+ * c_exponent = 0.25, which uses lap(). Checks that both yield the same loss
+ * and gradient and prints the time per call.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <iostream>
+#include <vector>
+
+#include "core/types.hpp"
+#include "loss/lap.hpp"
+#include "loss/ndcgdomainmodel.hpp"
+#include "utils/timer.hpp"
+
+namespace {
+
+    /**
+     * Orders items by decreasing score, ties by increasing item.
+     */
+    class ByDecreasingScore {
+    public:
+
+
+        ByDecreasingScore(const Real* f) : f(f) {
+        }
+
+
+        bool operator()(const size_t a, const size_t b) const {
+            return f[a] > f[b] || (f[a] == f[b] && a < b);
+        }
+
+    private:
+        const Real* f;
+    };
+
+
+    /**
+     * TruncatedAssignment before its inner loops ran on raw pointers.
+     */
+    class BeforeAssignment {
+    public:
+
+
+        void solve(const size_t n, const size_t k, const Real* gain, const Real* discount, const Real norm,
+                const Real* c, const Real* f, int* pi) {
+            if (n == 0) {
+                return;
+            }
+            u.assign(n + 1, 0.0);
+            v.assign(n + 1, 0.0);
+            p.assign(n + 1, 0);
+            way.resize(n + 1);
+            minv.resize(n + 1);
+            used.resize(n + 1);
+            order.resize(n);
+            for (size_t j = 0; j < n; ++j) {
+                order[j] = j;
+            }
+            std::sort(order.begin(), order.end(), ByDecreasingScore(f));
+
+            // Row k+r gets the item of rank r. The column duals are a concave
+            // function of f with slope -c[k+r] between the ranks r and r+1, such that
+            // the line of slope -c[k+r] through rank r lies above all of them. This
+            // makes u[k+r] + v[j] <= -c[k+r] * f[j], with equality at rank r.
+            const Real lastC = c[n - 1];
+            for (size_t r = 1; r < n; ++r) {
+                const Real slope = (k + r - 1 < n) ? c[k + r - 1] : lastC;
+                v[order[r] + 1] = v[order[r - 1] + 1] + slope * (f[order[r - 1]] - f[order[r]]);
+            }
+            for (size_t r = 0; k + r < n; ++r) {
+                const size_t row = k + r + 1;
+                const size_t col = order[r] + 1;
+                p[col] = row;
+                u[row] = -c[k + r] * f[order[r]] - v[col];
+            }
+
+            // Add the top rows, one shortest augmenting path each
+            const Real inf = std::numeric_limits<Real>::max();
+            for (size_t i = 1; i <= k; ++i) {
+                p[0] = i;
+                size_t j0 = 0;
+                std::fill(minv.begin(), minv.end(), inf);
+                std::fill(used.begin(), used.end(), 0);
+                do {
+                    used[j0] = 1;
+                    const size_t i0 = p[j0];
+                    const size_t row = i0 - 1;
+                    Real delta = inf;
+                    size_t j1 = 0;
+                    for (size_t j = 1; j <= n; ++j) {
+                        if (used[j]) continue;
+                        const Real cost = (row < k ? (gain[j - 1] / discount[row]) / norm : 0.0) - c[row] * f[j - 1];
+                        const Real cur = cost - u[i0] - v[j];
+                        if (cur < minv[j]) {
+                            minv[j] = cur;
+                            way[j] = j0;
+                        }
+                        if (minv[j] < delta) {
+                            delta = minv[j];
+                            j1 = j;
+                        }
+                    }
+                    for (size_t j = 0; j <= n; ++j) {
+                        if (used[j]) {
+                            u[p[j]] += delta;
+                            v[j] -= delta;
+                        } else {
+                            minv[j] -= delta;
+                        }
+                    }
+                    j0 = j1;
+                } while (p[j0] != 0);
+                do {
+                    const size_t j1 = way[j0];
+                    p[j0] = p[j1];
+                    j0 = j1;
+                } while (j0 != 0);
+            }
+
+            for (size_t j = 1; j <= n; ++j) {
+                pi[p[j] - 1] = static_cast<int> (j - 1);
+            }
+        }
+
+    private:
+        std::vector<Real> u;
+        std::vector<Real> v;
+        std::vector<size_t> p;
+        std::vector<size_t> way;
+        std::vector<Real> minv;
+        std::vector<char> used;
+        std::vector<size_t> order;
+    };
+
+
+    /**
+     * The loss and gradient as computed before the gains and discounts were
+     * cached.
+     */
+    class Before {
+    public:
+
+
+        Before(const cofi::XType& X, const cofi::YType& Y, const size_t trainK, const double c_exponent) :
+        X(X), Y(Y), trainK(trainK), c_exponent(c_exponent), c(Y.size1()) {
+            std::vector<Real> sorted(Y.size1());
+            for (size_t i = 0; i < Y.size1(); ++i) {
+                sorted[i] = Y(i, 0);
+                c[i] = pow((i + 1.0), c_exponent);
+            }
+            std::sort(sorted.begin(), sorted.end(), std::greater<Real > ());
+            perfectDCG = 0;
+            for (size_t i = 0; i < trainK; ++i) {
+                perfectDCG += (pow(2.0, sorted[i]) - 1.0) / log2(i + 2.0);
+            }
+        }
+
+
+        void ComputeLossPartGradient(cofi::WType& w, Real& loss, cofi::YType& grad) {
+            X.multiply(w, f);
+            ublas::vector<int> pi(Y.size1());
+            find_permutation(pi);
+            ublas::vector<size_t> pii(pi.size());
+            for (size_t i = 0; i < pi.size(); ++i) {
+                pii[pi[i]] = i;
+            }
+
+            Real scalarProd = 0;
+            for (size_t i = 0; i < Y.size1(); i++) {
+                scalarProd += c[i] * (f(pi[i], 0) - f(i, 0));
+                grad(i, 0) = c[pii[i]] - c[i];
+            }
+            Real d = 0.0;
+            for (size_t i = 0; i < trainK; i++) {
+                d += (pow(2.0, Y(pi[i], 0)) - 1.0) / log2(i + 2.0);
+            }
+            loss = 1.0 - d / perfectDCG + scalarProd;
+        }
+
+    private:
+
+
+        void find_permutation(ublas::vector<int>& pi) {
+            const size_t n = Y.size1();
+            if (c_exponent <= 0) {
+                gain.resize(n, false);
+                for (size_t j = 0; j < n; j++) {
+                    gain[j] = pow(2, Y(j, 0)) - 1;
+                }
+                discount.resize(trainK, false);
+                for (size_t i = 0; i < trainK; i++) {
+                    discount[i] = log2(i + 2);
+                }
+                assignment.solve(n, trainK, &gain(0), &discount(0), perfectDCG, &c(0), &f(0, 0), &pi(0));
+                return;
+            }
+
+            Real **C = new Real*[n];
+            for (size_t i = 0; i < n; i++) {
+                C[i] = new Real[n];
+                for (size_t j = 0; j < n; j++) {
+                    if (i < trainK) {
+                        C[i][j] = ((pow(2, Y(j, 0)) - 1) / log2(i + 2)) / perfectDCG - c[i] * f(j, 0);
+                    } else {
+                        C[i][j] = -c[i] * f(j, 0);
+                    }
+                }
+            }
+            ublas::vector<int> row(n);
+            lap(n, C, &pi(0), &row(0));
+            for (size_t i = 0; i < n; i++) {
+                delete[] C[i];
+            }
+            delete[] C;
+        }
+
+        const cofi::XType& X;
+        const cofi::YType& Y;
+        const size_t trainK;
+        const double c_exponent;
+        Real perfectDCG;
+        ublas::vector<Real> c;
+        ublas::vector<Real> gain;
+        ublas::vector<Real> discount;
+        cofi::YType f;
+        BeforeAssignment assignment;
+    };
+
+
+    Real random(void) {
+        return 2.0 * rand() / RAND_MAX - 1.0;
+    }
+
+
+    /**
+     * @return false, if the two implementations disagree.
+     */
+    bool run(const size_t n, const size_t dim, const size_t trainK, const double c_exponent, const size_t calls) {
+        ublas::matrix<double> M(n, dim);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < dim; ++j) {
+                M(i, j) = random();
+            }
+        }
+        cofi::XType X;
+        X.setSource(M);
+        X.resize(n);
+        cofi::YType Y(n, 1);
+        for (size_t i = 0; i < n; ++i) {
+            X.setIndex(i, i);
+            Y(i, 0) = 1 + rand() % 5;
+        }
+        std::vector<cofi::WType> ws(calls, cofi::WType(dim, 1));
+        for (size_t t = 0; t < calls; ++t) {
+            for (size_t j = 0; j < dim; ++j) {
+                ws[t](j, 0) = random();
+            }
+        }
+
+        NDCGDomainModel after(X, Y, trainK, c_exponent);
+        Before before(X, Y, trainK, c_exponent);
+        cofi::YType gradAfter(n, 1);
+        cofi::YType gradBefore(n, 1);
+        std::vector<Real> lossAfter(calls);
+        std::vector<Real> lossBefore(calls);
+
+        double start = WallClock();
+        for (size_t t = 0; t < calls; ++t) {
+            before.ComputeLossPartGradient(ws[t], lossBefore[t], gradBefore);
+        }
+        const double beforeTime = (WallClock() - start) / calls;
+        start = WallClock();
+        for (size_t t = 0; t < calls; ++t) {
+            after.ComputeLossPartGradient(ws[t], lossAfter[t], gradAfter);
+        }
+        const double afterTime = (WallClock() - start) / calls;
+        std::cout << "n=" << n << " c_exponent=" << c_exponent << ": before " << 1e3 * beforeTime << "ms, after "
+                << 1e3 * afterTime << "ms per call (" << beforeTime / afterTime << "x)" << std::endl;
+
+        bool same = true;
+        for (size_t t = 0; t < calls; ++t) {
+            same = same && fabs(lossBefore[t] - lossAfter[t]) <= 1e-9 * (1 + fabs(lossBefore[t]));
+        }
+        // The gradient depends on the permutation, which ties can change;
+        // random scores have none
+        for (size_t i = 0; i < n; ++i) {
+            same = same && fabs(gradBefore(i, 0) - gradAfter(i, 0)) <= 1e-9;
+        }
+        if (!same) {
+            std::cout << "ERROR: the loss or the gradient differs" << std::endl;
+        }
+        return same;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t dim = argc > 1 ? atoi(argv[1]) : 10;
+    const size_t trainK = argc > 2 ? atoi(argv[2]) : 10;
+
+    srand(1);
+    bool same = run(100, dim, trainK, -0.25, 2000);
+    same = run(1000, dim, trainK, -0.25, 50) && same;
+    same = run(100, dim, trainK, 0.25, 50) && same;
+    return same ? 0 : 1;
+}
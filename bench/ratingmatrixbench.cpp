@@ -0,0 +1,190 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Compares cofi::RatingMatrix with the ublas::compressed_matrix it replaced
+ * as DType.
+ *
+ * Usage: ratingmatrixbench [ROWS [RATINGS_PER_ROW [REPEATS]]]
+ *
+ * Builds a random matrix of ROWS users with RATINGS_PER_ROW ratings each in
+ * CSR form and times filling both matrices from it, as the loader does, and
+ * REPEATS traversals of all rows: with the ublas iterators, with find1() per
+ * row as the old UserIterator did, and by the row ranges of RatingMatrix.
+ * The column index of RatingMatrix is timed as well. Checks that all
+ * traversals see the same entries.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+#include "core/types.hpp"
+#include "core/ratingmatrix.hpp"
+#include "utils/timer.hpp"
+
+typedef ublas::compressed_matrix<cofi::EntryType> OldType;
+
+namespace {
+
+    void fill(OldType& m, const size_t rows, const size_t cols, const std::vector<size_t>& rowStart,
+            const std::vector<size_t>& columns, const std::vector<double>& values) {
+        const size_t nnz = columns.size();
+        m.resize(rows, cols, false);
+        m.reserve(nnz, false);
+        std::copy(columns.begin(), columns.end(), m.index2_data().begin());
+        std::copy(values.begin(), values.end(), m.value_data().begin());
+        std::copy(rowStart.begin(), rowStart.end(), m.index1_data().begin());
+        m.set_filled(rows + 1, nnz);
+    }
+
+
+    /**
+     * Sums value times column over all entries, so that no traversal can be
+     * optimized away and all can be compared.
+     */
+    double iterate(const OldType& m) {
+        double sum = 0;
+        for (OldType::const_iterator1 r = m.begin1(); r != m.end1(); ++r) {
+            for (OldType::const_iterator2 c = r.begin(); c != r.end(); ++c) {
+                sum += *c * c.index2();
+            }
+        }
+        return sum;
+    }
+
+
+    double findRows(const OldType& m) {
+        double sum = 0;
+        for (size_t i = 0; i < m.size1(); ++i) {
+            const OldType::const_iterator1 r = m.find1(0, i, 0);
+            for (OldType::const_iterator2 c = r.begin(); c != r.end(); ++c) {
+                sum += *c * c.index2();
+            }
+        }
+        return sum;
+    }
+
+
+    double rowRanges(const cofi::RatingMatrix& m) {
+        double sum = 0;
+        for (size_t i = 0; i < m.size1(); ++i) {
+            for (size_t e = m.rowBegin(i); e < m.rowEnd(i); ++e) {
+                sum += m.value(e) * m.column(e);
+            }
+        }
+        return sum;
+    }
+
+
+    double columnRanges(const cofi::RatingMatrix& m) {
+        double sum = 0;
+        for (size_t j = 0; j < m.size2(); ++j) {
+            for (size_t c = m.columnBegin(j); c < m.columnEnd(j); ++c) {
+                sum += m.value(m.entry(c)) * j;
+            }
+        }
+        return sum;
+    }
+
+
+    /**
+     * Times repeats calls of traverse and checks the sum against expected.
+     *
+     * @return the time of one call.
+     */
+    template<typename M>
+    double time(double (*traverse)(const M&), const M& m, const size_t repeats, const double expected, int& result) {
+        const double start = WallClock();
+        double sum = 0;
+        for (size_t k = 0; k < repeats; ++k) {
+            sum = traverse(m);
+        }
+        const double time = (WallClock() - start) / repeats;
+        if (sum != expected) {
+            std::cout << "ERROR: the traversal sums to " << sum << " instead of " << expected << std::endl;
+            result = 1;
+        }
+        return time;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t rows = argc > 1 ? atoi(argv[1]) : 50000;
+    const size_t perRow = argc > 2 ? atoi(argv[2]) : 100;
+    const size_t repeats = argc > 3 ? atoi(argv[3]) : 10;
+    const size_t cols = std::max<size_t > (10 * perRow, 1000);
+
+    std::vector<size_t> rowStart(1, 0);
+    std::vector<size_t> columns;
+    std::vector<double> values;
+    double expected = 0;
+    srand(1);
+    for (size_t i = 0; i < rows; ++i) {
+        std::vector<size_t> items;
+        for (size_t k = 0; k < perRow; ++k) {
+            items.push_back(rand() % cols);
+        }
+        std::sort(items.begin(), items.end());
+        items.erase(std::unique(items.begin(), items.end()), items.end());
+        for (size_t k = 0; k < items.size(); ++k) {
+            columns.push_back(items[k]);
+            values.push_back(1 + rand() % 5);
+            expected += values.back() * items[k];
+        }
+        rowStart.push_back(columns.size());
+    }
+    std::cout << rows << " x " << cols << ", " << columns.size() << " ratings" << std::endl;
+
+    double start = WallClock();
+    OldType old;
+    fill(old, rows, cols, rowStart, columns, values);
+    const double oldFill = WallClock() - start;
+    std::cout << "Fill compressed_matrix: " << oldFill << "s" << std::endl;
+
+    start = WallClock();
+    cofi::RatingMatrix m;
+    m.assign(rows, cols, &rowStart[0], &columns[0], &values[0]);
+    const double assign = WallClock() - start;
+    std::cout << "RatingMatrix::assign(): " << assign << "s (" << oldFill / assign << "x)" << std::endl;
+
+    // As from the CSR cache, the arrays stay with the caller
+    std::vector<size_t> adoptedStart(rowStart);
+    start = WallClock();
+    cofi::RatingMatrix adopted;
+    adopted.adopt(rows, cols, adoptedStart, NULL, &columns[0], &values[0]);
+    const double adopt = WallClock() - start;
+    std::cout << "RatingMatrix::adopt(): " << adopt << "s" << std::endl;
+
+    start = WallClock();
+    m.buildColumnIndex();
+    std::cout << "RatingMatrix::buildColumnIndex(): " << WallClock() - start << "s" << std::endl;
+
+    int result = 0;
+    const double iterators = time(iterate, old, repeats, expected, result);
+    std::cout << "Traverse compressed_matrix by iterators: " << iterators << "s" << std::endl;
+    const double find1 = time(findRows, old, repeats, expected, result);
+    std::cout << "Traverse compressed_matrix by find1() per row: " << find1 << "s" << std::endl;
+    const double ranges = time(rowRanges, m, repeats, expected, result);
+    std::cout << "Traverse RatingMatrix by rows: " << ranges << "s (" << iterators / ranges << "x, "
+            << find1 / ranges << "x)" << std::endl;
+    std::cout << "Traverse RatingMatrix by columns: " << time(columnRanges, m, repeats, expected, result) << "s" << std::endl;
+    return result;
+}
@@ -0,0 +1,123 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Compares the solvers BMRM, LBFGS and SUBGRADIENT by the time they take to
+ * reach an objective.
+ *
+ * Usage: solverbench [USERS [ITEMS [RATINGS_PER_USER [ITERATIONS [CONFIG]]]]]
+ *
+ * Writes random training and test files and trains on them with the options
+ * of CONFIG, by default config/default.cfg, and each loss and solver,
+ * starting from the same U and M, for ITERATIONS user and movie phases. After
+ * each phase, it prints the time of the phase and the objective
+ * loss(U, M) + userLambda/2 |U|^2 + movieLambda/2 |M|^2.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "benchutils.hpp"
+#include "core/types.hpp"
+#include "cofi/movietrainer.hpp"
+#include "cofi/problem.hpp"
+#include "cofi/usertrainer.hpp"
+#include "loss/moviephaselossfunction.hpp"
+#include "utils/configuration.hpp"
+#include "utils/timer.hpp"
+
+namespace {
+
+    Real objective(cofi::Problem& p, const Real userLambda, const Real movieLambda) {
+        cofi::MoviePhaseLossFunction m(p);
+        cofi::MType grad(p.getM().size1(), p.getM().size2());
+        Real loss = 0;
+        m.ComputeLossGradient(p.getM(), loss, grad);
+        const Real u = norm_frobenius(p.getU());
+        const Real v = norm_frobenius(p.getM());
+        return loss + userLambda / 2 * u * u + movieLambda / 2 * v * v;
+    }
+
+
+    /**
+     * Trains with the given loss and each solver.
+     */
+    class SolverRun : public cofi::bench::LossRun {
+    public:
+
+
+        SolverRun(const size_t nIterations) : nIterations(nIterations) {
+        }
+
+
+        int run(const std::string& loss) {
+            Configuration& conf = Configuration::getInstance();
+            const Real userLambda = conf.getDouble("cofi.userphase.lambda");
+            const Real movieLambda = conf.getDouble("cofi.moviephase.lambda");
+            const char* solvers[] = {"BMRM", "LBFGS", "SUBGRADIENT"};
+            for (size_t s = 0; s < 3; ++s) {
+                conf.setString("cofi.solver", solvers[s]);
+                srand(2);
+                cofi::Problem p;
+                cofi::UserTrainer userPhase;
+                cofi::MovieTrainer moviePhase;
+                std::cout << loss << ", " << solvers[s] << ": start " << objective(p, userLambda, movieLambda) << std::endl;
+                double total = 0;
+                for (size_t t = 0; t < nIterations; ++t) {
+                    double start = WallClock();
+                    userPhase.run(p, t, userLambda);
+                    const double userTime = WallClock() - start;
+                    const Real userObjective = objective(p, userLambda, movieLambda);
+                    start = WallClock();
+                    moviePhase.run(p, t, movieLambda);
+                    const double movieTime = WallClock() - start;
+                    const Real movieObjective = objective(p, userLambda, movieLambda);
+                    total += userTime + movieTime;
+                    std::cout << "  " << t + 1 << ": user phase " << userTime << "s, objective " << userObjective
+                            << "; movie phase " << movieTime << "s, objective " << movieObjective
+                            << "; total " << total << "s" << std::endl;
+                }
+            }
+            return 0;
+        }
+
+    private:
+        const size_t nIterations;
+    };
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nUsers = argc > 1 ? atoi(argv[1]) : 500;
+    const size_t nItems = argc > 2 ? atoi(argv[2]) : 300;
+    const size_t perUser = argc > 3 ? atoi(argv[3]) : 30;
+    const size_t nIterations = argc > 4 ? atoi(argv[4]) : 3;
+    const std::string configFile = argc > 5 ? argv[5] : "config/default.cfg";
+    const std::string trainFile = "/tmp/cofirank-solverbench-train.lsvm";
+    const std::string testFile = "/tmp/cofirank-solverbench-test.lsvm";
+
+    srand(1);
+    cofi::bench::writeRatings(trainFile, nUsers, perUser, nItems);
+    cofi::bench::writeRatings(testFile, nUsers, 10, nItems);
+    std::cout << nUsers << " users, " << nItems << " items, " << perUser << " ratings per user" << std::endl;
+
+    SolverRun r(nIterations);
+    const int result = cofi::bench::forEachLoss(r, configFile, trainFile, testFile);
+    remove(trainFile.c_str());
+    remove(testFile.c_str());
+    return result;
+}
@@ -0,0 +1,88 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Compares the SVMLight loader with SVMLightReader<M>::process.
+ *
+ * Usage: svmlightloaderbench [ROWS [RATINGS_PER_ROW [THREADS [FILE]]]]
+ *
+ * Writes a random file of ROWS users with RATINGS_PER_ROW ratings each,
+ * loads it with resizeAndLoadMatrix() into a compressed_matrix and with
+ * loadSVMLight() into CSR form, checks that both agree and prints the times.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+#include "benchutils.hpp"
+#include "core/types.hpp"
+#include "io/io.hpp"
+#include "io/svmlightloader.hpp"
+#include "utils/timer.hpp"
+
+typedef ublas::compressed_matrix<Real> OldType;
+
+namespace {
+
+    bool same(const OldType& m, const cofi::io::CSRData& data) {
+        if (m.size1() != data.size1() || m.size2() != data.size2() || m.nnz() != data.nnz()) return false;
+        size_t e = 0;
+        for (OldType::const_iterator1 r = m.begin1(); r != m.end1(); ++r) {
+            for (OldType::const_iterator2 c = r.begin(); c != r.end(); ++c, ++e) {
+                if (data.columns()[e] != c.index2() || data.values()[e] != *c) return false;
+                if (e < data.rowStart()[c.index1()] || e >= data.rowStart()[c.index1() + 1]) return false;
+            }
+        }
+        return e == data.nnz();
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t rows = argc > 1 ? atoi(argv[1]) : 20000;
+    const size_t perRow = argc > 2 ? atoi(argv[2]) : 50;
+    const size_t threads = argc > 3 ? atoi(argv[3]) : 4;
+    const std::string filename = argc > 4 ? argv[4] : "/tmp/cofirank-svmlightloaderbench.lsvm";
+    const size_t cols = std::max<size_t > (10 * perRow, 1000);
+
+    srand(1);
+    cofi::bench::writeRatings(filename, rows, perRow, cols);
+    std::cout << rows << " rows, " << rows * perRow << " ratings" << std::endl;
+
+    double start = WallClock();
+    OldType old;
+    cofi::io::resizeAndLoadMatrix(old, filename);
+    const double oldTime = WallClock() - start;
+    std::cout << "SVMLightReader<M>::process (two passes): " << oldTime << "s" << std::endl;
+
+    int result = 0;
+    for (size_t t = 1; t <= threads; t *= 2) {
+        start = WallClock();
+        cofi::io::CSRData data;
+        cofi::io::loadSVMLight(filename, data, t);
+        const double time = WallClock() - start;
+        std::cout << "loadSVMLight, " << t << " threads: " << time << "s (" << oldTime / time << "x)" << std::endl;
+        if (!same(old, data)) {
+            std::cout << "ERROR: loadSVMLight differs from SVMLightReader" << std::endl;
+            result = 1;
+        }
+    }
+    remove(filename.c_str());
+    return result;
+}
@@ -58,7 +58,20 @@ OBJECTFILES= \
 	${OBJECTDIR}/src/loss/leastsquaredomainmodel.o \
 	${OBJECTDIR}/src/loss/userloss.o \
 	${OBJECTDIR}/src/cofi/eval/ndcgevaluator.o \
-	${OBJECTDIR}/src/cofi/eval/timeevaluator.o
+	${OBJECTDIR}/src/cofi/eval/timeevaluator.o \
+	${OBJECTDIR}/src/utils/parallel.o \
+	${OBJECTDIR}/src/io/mappedfile.o \
+	${OBJECTDIR}/src/io/svmlightloader.o \
+	${OBJECTDIR}/src/io/csrcache.o \
+	${OBJECTDIR}/src/io/bufferedwriter.o \
+	${OBJECTDIR}/src/io/modelio.o \
+	${OBJECTDIR}/src/cofi/recommender.o \
+	${OBJECTDIR}/src/cofi/itemindex.o \
+	${OBJECTDIR}/src/cofi/foldin.o \
+	${OBJECTDIR}/src/loss/truncatedassignment.o \
+	${OBJECTDIR}/src/bmrm/lbfgs.o \
+	${OBJECTDIR}/src/bmrm/subgradient.o \
+	${OBJECTDIR}/src/core/ratingmatrix.o
 
 # C Compiler Flags
 CFLAGS=
@@ -71,7 +84,7 @@ CXXFLAGS=-D NDEBUG
 FFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-lpthread
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -205,6 +218,58 @@ ${OBJECTDIR}/src/cofi/eval/timeevaluator.o: src/cofi/eval/timeevaluator.cpp
 	${MKDIR} -p ${OBJECTDIR}/src/cofi/eval
 	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/cofi/eval/timeevaluator.o src/cofi/eval/timeevaluator.cpp
 
+${OBJECTDIR}/src/utils/parallel.o: src/utils/parallel.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/utils
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/utils/parallel.o src/utils/parallel.cpp
+
+${OBJECTDIR}/src/io/mappedfile.o: src/io/mappedfile.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/io
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/io/mappedfile.o src/io/mappedfile.cpp
+
+${OBJECTDIR}/src/io/svmlightloader.o: src/io/svmlightloader.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/io
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/io/svmlightloader.o src/io/svmlightloader.cpp
+
+${OBJECTDIR}/src/io/csrcache.o: src/io/csrcache.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/io
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/io/csrcache.o src/io/csrcache.cpp
+
+${OBJECTDIR}/src/io/bufferedwriter.o: src/io/bufferedwriter.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/io
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/io/bufferedwriter.o src/io/bufferedwriter.cpp
+
+${OBJECTDIR}/src/io/modelio.o: src/io/modelio.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/io
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/io/modelio.o src/io/modelio.cpp
+
+${OBJECTDIR}/src/cofi/recommender.o: src/cofi/recommender.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cofi
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/cofi/recommender.o src/cofi/recommender.cpp
+
+${OBJECTDIR}/src/cofi/itemindex.o: src/cofi/itemindex.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cofi
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/cofi/itemindex.o src/cofi/itemindex.cpp
+
+${OBJECTDIR}/src/cofi/foldin.o: src/cofi/foldin.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cofi
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/cofi/foldin.o src/cofi/foldin.cpp
+
+${OBJECTDIR}/src/loss/truncatedassignment.o: src/loss/truncatedassignment.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/loss
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/loss/truncatedassignment.o src/loss/truncatedassignment.cpp
+
+${OBJECTDIR}/src/bmrm/lbfgs.o: src/bmrm/lbfgs.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/bmrm
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/bmrm/lbfgs.o src/bmrm/lbfgs.cpp
+
+${OBJECTDIR}/src/bmrm/subgradient.o: src/bmrm/subgradient.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/bmrm
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/bmrm/subgradient.o src/bmrm/subgradient.cpp
+
+${OBJECTDIR}/src/core/ratingmatrix.o: src/core/ratingmatrix.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/core
+	$(COMPILE.cc) -g -Isrc -Ilibs -o ${OBJECTDIR}/src/core/ratingmatrix.o src/core/ratingmatrix.cpp
+
 # Subprojects
 .build-subprojects:
 
@@ -11,6 +11,7 @@
 #include "lossfunction.hpp"
 #include "utils/configuration.hpp"
 #include "core/cofiexception.hpp"
+#include "utils/timer.hpp"
 #include "solver/innersolver.hpp"
 
 /**  
@@ -18,7 +19,7 @@
  *
  *  @param model [read] pointer to loss model object
  */
-BMRM::BMRM(LossFunction& lossFunction, const Real lambda, const size_t dimW) : lossFunction(lossFunction), lambda(lambda), dimW(dimW) {
+BMRM::BMRM(LossFunction& lossFunction, const Real lambda, const size_t dimW, const DualInnerSolverSettings& settings) : lossFunction(lossFunction), lambda(lambda), dimW(dimW), lossTime(0), evaluations(0), warmStart(NULL), warmStartPlanes(0) {
     // set private members (default) values
     maxNumOfIter = 100;
     epsilonTol = 0.1;
@@ -28,7 +29,7 @@ BMRM::BMRM(LossFunction& lossFunction, const Real lambda, const size_t dimW) : l
 
 
     // instantiate inner solver
-    innerSolver = new DaiFletcherPGM(lambda);
+    innerSolver = new DaiFletcherPGM(lambda, settings);
 }
 
 /**  Destructor
@@ -58,6 +59,34 @@ Real BMRM::train(ublas::matrix<Real>& w) {
 
     ublas::matrix<Real> w_final(w.size1(), w.size2()); // w_t at which pobj is the smallest (t>=2, i.e., initial w is not considered)
     ublas::matrix<Real> gradient(w.size1(), w.size2());
+    unsigned int finalIter = 0; // the iteration w_final is from
+    std::vector<ublas::matrix<Real> > recent; // the last points, recent[t % recent.size()] from iteration t
+    if (warmStart) {
+        recent.resize(warmStartPlanes + 1);
+
+        // Re-linearize the loss at the points of the last solve. Their planes
+        // are valid for the current loss, too. Some losses, like the movie
+        // phase, compute the loss of the matrix w refers to in place, hence
+        // each point is evaluated in w, which is restored afterwards. The
+        // points do not update minExactObjVal, as they cannot become w_final.
+        const ublas::matrix<Real> initialW(w);
+        for (size_t i = 0; i < warmStart->points.size(); ++i) {
+            const ublas::matrix<Real>& point = warmStart->points[i];
+            if (point.size1() != w.size1() || point.size2() != w.size2()) {
+                continue;
+            }
+            w = point;
+            const double start = WallClock();
+            lossFunction.ComputeLossGradient(w, loss, gradient);
+            lossTime += WallClock() - start;
+            evaluations++;
+            innerSolver->AddCuttingPlane(w, gradient, loss);
+        }
+        w = initialW;
+        if (warmStart->tolerance > 0) {
+            innerSolverTol = warmStart->tolerance;
+        }
+    }
     #ifndef NDEBUG
     std::clog << "gammaTol: " << gammaTol << " epsilonTol: " << epsilonTol << " relGammaTol: " << relGammaTol << " relEpsilonTol: "<< relEpsilonTol << " maxIter: " << maxNumOfIter << std::endl;
     #endif
@@ -66,7 +95,13 @@ Real BMRM::train(ublas::matrix<Real>& w) {
        
 
         // column generation
+        const double start = WallClock();
         lossFunction.ComputeLossGradient(w, loss, gradient);
+        lossTime += WallClock() - start;
+        evaluations++;
+        if (warmStart) {
+            recent[iter % recent.size()] = w;
+        }
 
         assert(gradient.size1() == w.size1() && gradient.size2() == w.size2());
         assert(loss >= 0.0);
@@ -80,6 +115,7 @@ Real BMRM::train(ublas::matrix<Real>& w) {
             finalLoss = loss;
             finalRegVal = regVal;
             w_final = w;
+            finalIter = iter;
         } else if (iter > 2) {
 
             if (finalExactObjVal > exactObjVal) {
@@ -87,6 +123,7 @@ Real BMRM::train(ublas::matrix<Real>& w) {
                 finalLoss = loss;
                 finalRegVal = regVal;
                 w_final = w;
+                finalIter = iter;
             }
         }
 
@@ -154,6 +191,17 @@ Real BMRM::train(ublas::matrix<Real>& w) {
     //    double diffnorm = norm_frobenius(w-w_final);
     // printf("\n AK Note,  ||w - w_final||  : %f \n", diffnorm);    
     w = w_final;
+
+    // Keep the newest points besides w_final, from which the next solve starts anyway
+    if (warmStart) {
+        warmStart->points.clear();
+        for (unsigned int t = iter; t > 0 && t + recent.size() > iter && warmStart->points.size() < warmStartPlanes; --t) {
+            if (t != finalIter) {
+                warmStart->points.push_back(recent[t % recent.size()]);
+            }
+        }
+        warmStart->tolerance = innerSolverTol;
+    }
      #ifndef NDEBUG
       std::clog << "Final Loss " << loss<< std::endl;
      #endif
@@ -162,6 +210,17 @@ Real BMRM::train(ublas::matrix<Real>& w) {
 
 }
 
+void BMRM::addStatistics(BundleStatistics& statistics) const {
+    statistics.iterations += evaluations;
+    statistics.loss += lossTime;
+    innerSolver->AddStatistics(statistics);
+}
+
+void BMRM::setWarmStart(BMRMWarmStart* state, const size_t planes) {
+    warmStart = planes > 0 ? state : NULL;
+    warmStartPlanes = planes;
+}
+
 void BMRM::setConvergence(double gammaTol, double epsilonTol, double relEpsilonTol, double relGammaTol, int maxIter) {
     this -> relGammaTol = relGammaTol;
     this -> relEpsilonTol = relEpsilonTol;
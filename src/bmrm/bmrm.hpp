@@ -2,11 +2,31 @@
 #define _BMRM_HPP_
 
 #include <string>
+#include <vector>
 #include "core/types.hpp"
 #include "solver/innersolver.hpp"
 #include "solver/daifletcherpgm.hpp"
 #include "lossfunction.hpp"
 
+/**
+ * What BMRM keeps between the solves of a problem that changes a little from
+ * one solve to the next, like the user problems between the iterations of
+ * COFIBMRM.
+ */
+struct BMRMWarmStart {
+    /** The last points the loss was evaluated at, except the solution. The
+     *  next solve adds the planes of its loss at them to the bundle first.
+     */
+    std::vector<ublas::matrix<Real> > points;
+
+    /** The final tolerance of the inner solver, 0 before the first solve
+     */
+    double tolerance;
+
+    BMRMWarmStart() : tolerance(0) {
+    }
+};
+
 /**   Class for BMRM solver.
  *    This type of solver iteratively builds up a convex lower-bound of the 
  *      objective function, and performs minimization on the lower-bound.
@@ -15,7 +35,8 @@ class BMRM {
 public:
 
     // Constructors
-    BMRM(LossFunction& lossFunction, const Real lambda, const size_t dimW);
+    BMRM(LossFunction& lossFunction, const Real lambda, const size_t dimW,
+            const DualInnerSolverSettings& settings = DualInnerSolverSettings());
 
     // Destructor
     virtual ~BMRM();
@@ -32,6 +53,18 @@ public:
      */
     void setConvergence(double gammaTol = 0.01, double epsilonTol = 1e-2, double relEpsilonTol=0.1, double relGammaTol=0.1, int maxIter = 4000);
 
+    /**
+     * Adds the time spent in the phases of train() so far, and the memory
+     * of the bundle, to statistics.
+     */
+    void addStatistics(BundleStatistics& statistics) const;
+
+    /**
+     * Warm starts train() from state and keeps up to planes points for the
+     * next solve in it.
+     */
+    void setWarmStart(BMRMWarmStart* state, const size_t planes);
+
 
 
 protected:
@@ -82,6 +115,22 @@ protected:
      */
     InnerSolver* innerSolver; // pointer to inner solver object
 
+    /** Time spent in computing the loss and its gradient
+     */
+    double lossTime;
+
+    /** Number of evaluations of the loss
+     */
+    size_t evaluations;
+
+    /** The warm start state, NULL for a cold start
+     */
+    BMRMWarmStart* warmStart;
+
+    /** The number of points to keep in warmStart
+     */
+    size_t warmStartPlanes;
+
 
 };
 
@@ -0,0 +1,162 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "lbfgs.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/timer.hpp"
+#include "utils/ublastools.hpp"
+
+namespace {
+    // Sufficient decrease of the line search
+    const Real ARMIJO = 1e-4;
+
+    // Halvings of the step before the line search gives up
+    const int MAX_LINE_SEARCH = 30;
+
+    // Smallest curvature s'y of a correction pair that is kept
+    const Real MIN_CURVATURE = 1e-12;
+}
+
+
+LBFGS::LBFGS(LossFunction& lossFunction, const Real lambda) :
+lossFunction(lossFunction), lambda(lambda), memory(5), minRelativeProgress(1e-4), maxIter(100), lossTime(0), evaluations(0) {
+}
+
+
+void LBFGS::setConvergence(const size_t memory, const double minRelativeProgress, const int maxIter) {
+    this->memory = std::max<size_t > (memory, 1);
+    this->minRelativeProgress = minRelativeProgress;
+    this->maxIter = maxIter;
+}
+
+
+void LBFGS::addStatistics(BundleStatistics& statistics) const {
+    statistics.iterations += evaluations;
+    statistics.loss += lossTime;
+}
+
+
+Real LBFGS::evaluate(ublas::matrix<Real>& w, Real& loss, ublas::matrix<Real>& gradient) {
+    const double start = WallClock();
+    lossFunction.ComputeLossGradient(w, loss, gradient);
+    lossTime += WallClock() - start;
+    evaluations++;
+    gradient += lambda * w;
+    const Real norm = ublas::norm_frobenius(w);
+    return loss + 0.5 * lambda * norm * norm;
+}
+
+
+Real LBFGS::train(ublas::matrix<Real>& w) {
+    const size_t rows = w.size1();
+    const size_t cols = w.size2();
+    ublas::matrix<Real> g(rows, cols);
+    ublas::matrix<Real> gNew(rows, cols);
+    ublas::matrix<Real> d(rows, cols);
+    ublas::matrix<Real> wOld(rows, cols);
+    s.assign(memory, ublas::matrix<Real > (rows, cols));
+    y.assign(memory, ublas::matrix<Real > (rows, cols));
+    rho.assign(memory, 0.0);
+    std::vector<Real> alpha(memory, 0.0);
+    size_t stored = 0;
+    size_t newest = memory - 1;
+
+    Real loss = 0.0;
+    Real J = evaluate(w, loss, g);
+    for (int iter = 0; iter < maxIter; ++iter) {
+        // d = -H g by the two loop recursion, H0 scaled by the newest pair
+        d = g;
+        for (size_t k = 0; k < stored; ++k) {
+            const size_t i = (newest + memory - k) % memory;
+            alpha[i] = rho[i] * cofi::ublastools::inner_prod(s[i], d);
+            d -= alpha[i] * y[i];
+        }
+        if (stored > 0) {
+            d *= 1.0 / (rho[newest] * cofi::ublastools::inner_prod(y[newest], y[newest]));
+        } else {
+            // A first step of unit length
+            const Real norm = ublas::norm_frobenius(g);
+            if (norm == 0.0) {
+                break;
+            }
+            d *= 1.0 / norm;
+        }
+        for (size_t k = stored; k > 0; --k) {
+            const size_t i = (newest + memory - (k - 1)) % memory;
+            const Real beta = rho[i] * cofi::ublastools::inner_prod(y[i], d);
+            d += (alpha[i] - beta) * s[i];
+        }
+        d *= -1.0;
+
+        Real slope = cofi::ublastools::inner_prod(g, d);
+        if (slope >= 0 && stored > 0) {
+            // Not a descent direction, restart from the gradient
+            stored = 0;
+            d = g * (-1.0 / ublas::norm_frobenius(g));
+            slope = cofi::ublastools::inner_prod(g, d);
+        }
+        if (!(slope < 0)) {
+            break;
+        }
+
+        // The loss is evaluated at w itself, as the loss of the movie phase
+        // reads M through the Problem.
+        Real step = 1.0;
+        Real lossNew = 0.0;
+        Real JNew = 0.0;
+        bool accepted = false;
+        wOld = w;
+        for (int i = 0; i < MAX_LINE_SEARCH && !accepted; ++i) {
+            noalias(w) = wOld + step * d;
+            JNew = evaluate(w, lossNew, gNew);
+            if (JNew <= J + ARMIJO * step * slope) {
+                accepted = true;
+            } else {
+                step *= 0.5;
+            }
+        }
+        if (!accepted) {
+            w = wOld;
+            break;
+        }
+
+        // The new pair is s = step * d and y = gNew - g. It replaces the
+        // oldest one only if its curvature is positive.
+        d *= step;
+        g = gNew - g;
+        const Real curvature = cofi::ublastools::inner_prod(d, g);
+        if (curvature > MIN_CURVATURE) {
+            const size_t next = (newest + 1) % memory;
+            s[next].swap(d);
+            y[next].swap(g);
+            rho[next] = 1.0 / curvature;
+            newest = next;
+            stored = std::min(stored + 1, memory);
+        }
+
+        const Real progress = (J - JNew) / std::fabs(JNew);
+        g.swap(gNew);
+        J = JNew;
+        loss = lossNew;
+        if (progress < minRelativeProgress) {
+            break;
+        }
+    }
+    return loss;
+}
@@ -0,0 +1,85 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _LBFGS_HPP_
+#define _LBFGS_HPP_
+
+#include <vector>
+#include "core/types.hpp"
+#include "lossfunction.hpp"
+#include "solver/innersolver.hpp"
+
+/**
+ * Limited memory BFGS on the regularized risk
+ *
+ *   J(w) = loss(w) + lambda/2 |w|^2
+ *
+ * with a backtracking (Armijo) line search.
+ *
+ * This needs one gradient per iteration and no QP, which makes it cheaper
+ * than BMRM on smooth losses like the squared error. On the non smooth
+ * ranking losses it still descends, but stops once the line search finds no
+ * more progress.
+ */
+class LBFGS {
+public:
+    LBFGS(LossFunction& lossFunction, const Real lambda);
+
+    /**
+     * Minimizes J starting from w. The loss is only ever evaluated at w
+     * itself.
+     *
+     * @param w [r/w] the start and the solution.
+     * @return the loss at the solution.
+     */
+    Real train(ublas::matrix<Real>& w);
+
+    /**
+     * @param memory the number of correction pairs kept.
+     * @param minRelativeProgress stop once J decreases by less than this
+     *        fraction in an iteration.
+     * @param maxIter the maximum number of iterations.
+     */
+    void setConvergence(const size_t memory, const double minRelativeProgress, const int maxIter);
+
+    /**
+     * Adds the time spent in the loss and the number of its evaluations to
+     * statistics.
+     */
+    void addStatistics(BundleStatistics& statistics) const;
+
+private:
+    /**
+     * Computes J and its gradient at w.
+     */
+    Real evaluate(ublas::matrix<Real>& w, Real& loss, ublas::matrix<Real>& gradient);
+
+    LossFunction& lossFunction;
+    const Real lambda;
+    size_t memory;
+    double minRelativeProgress;
+    int maxIter;
+
+    double lossTime;
+    size_t evaluations;
+
+    // The correction pairs s = w' - w and y = g' - g, in a ring buffer
+    std::vector<ublas::matrix<Real> > s;
+    std::vector<ublas::matrix<Real> > y;
+    std::vector<Real> rho;
+};
+
+#endif /* _LBFGS_HPP_ */
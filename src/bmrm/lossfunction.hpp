@@ -34,8 +34,8 @@ public:
      * @param F the computed prediction.
      *
      */
-    virtual inline void predict(cofi::WType& W, cofi::WType& X, ublas::matrix<Real>& F){
-        F = prod(X,W);
+    virtual inline void predict(cofi::WType& W, cofi::XType& X, ublas::matrix<Real>& F){
+        X.multiply(W, F);
     }
     
 };
@@ -30,8 +30,278 @@
 #define INFTY     1e30
 #define ZERO_EPS  1e-16
 
-DaiFletcherPGM::DaiFletcherPGM(double lambda)
-   : DualInnerSolver(lambda),
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PGM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+/** The loops the solver spends its time in. All of them run over the dim
+ *  entries of the QP, Q*d is built from AddScaled on its columns.
+ *
+ *  The vector kernels give the same x in Project, AddScaled and Step as the
+ *  scalar ones, but sum the products in lane order, which can change the
+ *  last bits of the sums. They are only used with DaiFletcherPGM.simd 1.
+ */
+struct PGMKernels
+{
+   const char *name;
+
+   /** y += alpha * col
+    */
+   void (*addScaled)(int n, double alpha, const double *col, double *y);
+
+   /** a'b
+    */
+   double (*dot)(int n, const double *a, const double *b);
+
+   /** x = min(max(-c + lambda*a, l), u), returns a'x
+    */
+   double (*project)(int n, double lambda, const double *a, const double *c,
+                     const double *l, const double *u, double *x);
+
+   /** xplus = x + step*d, tplus = t + step*Qd, returns xplus'(0.5*tplus + f)
+    */
+   double (*step)(int n, double step, const double *x, const double *d, const double *t,
+                  const double *Qd, const double *f, double *xplus, double *tplus);
+};
+
+
+namespace
+{
+   void AddScaledScalar(int n, double alpha, const double *col, double *y)
+   {
+      for (int i = 0; i < n; i++)
+         y[i] += (col[i] * alpha);
+   }
+
+   double DotScalar(int n, const double *a, const double *b)
+   {
+      double r = 0.0;
+      for (int i = 0; i < n; i++)
+         r += a[i] * b[i];
+      return r;
+   }
+
+   double ProjectScalar(int n, double lambda, const double *a, const double *c,
+                        const double *l, const double *u, double *x)
+   {
+      double r = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+         x[i] = -c[i] + lambda*a[i];
+         if (x[i] > u[i])
+            x[i] = u[i];
+         else if (x[i] < l[i])
+            x[i] = l[i];
+         r += a[i]*x[i];
+      }
+      return r;
+   }
+
+   double StepScalar(int n, double step, const double *x, const double *d, const double *t,
+                     const double *Qd, const double *f, double *xplus, double *tplus)
+   {
+      double fv = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+         xplus[i] = x[i] + step*d[i];
+         tplus[i] = t[i] + step*Qd[i];
+         fv      += xplus[i] * (0.5*tplus[i] + f[i]);
+      }
+      return fv;
+   }
+
+   const PGMKernels scalarKernels = {"scalar", AddScaledScalar, DotScalar, ProjectScalar, StepScalar};
+
+
+#ifdef PGM_X86_KERNELS
+   // Four lanes of 256 bit AVX, the remainder is done in scalar code
+
+   __attribute__((target("avx")))
+   double SumAVX(const __m256d &v)
+   {
+      double lanes[4];
+      _mm256_storeu_pd(lanes, v);
+      return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+   }
+
+   __attribute__((target("avx")))
+   void AddScaledAVX(int n, double alpha, const double *col, double *y)
+   {
+      const __m256d va = _mm256_set1_pd(alpha);
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+         _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i),
+                                               _mm256_mul_pd(_mm256_loadu_pd(col + i), va)));
+      for (; i < n; i++)
+         y[i] += (col[i] * alpha);
+   }
+
+   __attribute__((target("avx")))
+   double DotAVX(int n, const double *a, const double *b)
+   {
+      __m256d vr = _mm256_setzero_pd();
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+         vr = _mm256_add_pd(vr, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+      double r = SumAVX(vr);
+      for (; i < n; i++)
+         r += a[i] * b[i];
+      return r;
+   }
+
+   __attribute__((target("avx")))
+   double ProjectAVX(int n, double lambda, const double *a, const double *c,
+                     const double *l, const double *u, double *x)
+   {
+      const __m256d vlambda = _mm256_set1_pd(lambda);
+      __m256d vr = _mm256_setzero_pd();
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+         const __m256d va = _mm256_loadu_pd(a + i);
+         __m256d vx = _mm256_sub_pd(_mm256_mul_pd(vlambda, va), _mm256_loadu_pd(c + i));
+         vx = _mm256_max_pd(_mm256_min_pd(vx, _mm256_loadu_pd(u + i)), _mm256_loadu_pd(l + i));
+         _mm256_storeu_pd(x + i, vx);
+         vr = _mm256_add_pd(vr, _mm256_mul_pd(va, vx));
+      }
+      double r = SumAVX(vr);
+      for (; i < n; i++)
+      {
+         x[i] = -c[i] + lambda*a[i];
+         if (x[i] > u[i])
+            x[i] = u[i];
+         else if (x[i] < l[i])
+            x[i] = l[i];
+         r += a[i]*x[i];
+      }
+      return r;
+   }
+
+   __attribute__((target("avx")))
+   double StepAVX(int n, double step, const double *x, const double *d, const double *t,
+                  const double *Qd, const double *f, double *xplus, double *tplus)
+   {
+      const __m256d vstep = _mm256_set1_pd(step);
+      const __m256d vhalf = _mm256_set1_pd(0.5);
+      __m256d vfv = _mm256_setzero_pd();
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+         const __m256d vx = _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_mul_pd(vstep, _mm256_loadu_pd(d + i)));
+         const __m256d vt = _mm256_add_pd(_mm256_loadu_pd(t + i), _mm256_mul_pd(vstep, _mm256_loadu_pd(Qd + i)));
+         _mm256_storeu_pd(xplus + i, vx);
+         _mm256_storeu_pd(tplus + i, vt);
+         vfv = _mm256_add_pd(vfv, _mm256_mul_pd(vx, _mm256_add_pd(_mm256_mul_pd(vhalf, vt), _mm256_loadu_pd(f + i))));
+      }
+      double fv = SumAVX(vfv);
+      for (; i < n; i++)
+      {
+         xplus[i] = x[i] + step*d[i];
+         tplus[i] = t[i] + step*Qd[i];
+         fv      += xplus[i] * (0.5*tplus[i] + f[i]);
+      }
+      return fv;
+   }
+
+   const PGMKernels avxKernels = {"avx", AddScaledAVX, DotAVX, ProjectAVX, StepAVX};
+
+
+   // Eight lanes of AVX-512, the remainder is done in a masked pass
+
+   __attribute__((target("avx512f")))
+   __mmask8 TailAVX512(int remaining)
+   {
+      return static_cast<__mmask8>(remaining >= 8 ? 0xFF : (1u << remaining) - 1);
+   }
+
+   __attribute__((target("avx512f")))
+   void AddScaledAVX512(int n, double alpha, const double *col, double *y)
+   {
+      const __m512d va = _mm512_set1_pd(alpha);
+      for (int i = 0; i < n; i += 8)
+      {
+         const __mmask8 m = TailAVX512(n - i);
+         _mm512_mask_storeu_pd(y + i, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, y + i),
+                                                       _mm512_mul_pd(_mm512_maskz_loadu_pd(m, col + i), va)));
+      }
+   }
+
+   __attribute__((target("avx512f")))
+   double DotAVX512(int n, const double *a, const double *b)
+   {
+      __m512d vr = _mm512_setzero_pd();
+      for (int i = 0; i < n; i += 8)
+      {
+         const __mmask8 m = TailAVX512(n - i);
+         vr = _mm512_add_pd(vr, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a + i), _mm512_maskz_loadu_pd(m, b + i)));
+      }
+      return _mm512_reduce_add_pd(vr);
+   }
+
+   __attribute__((target("avx512f")))
+   double ProjectAVX512(int n, double lambda, const double *a, const double *c,
+                        const double *l, const double *u, double *x)
+   {
+      const __m512d vlambda = _mm512_set1_pd(lambda);
+      __m512d vr = _mm512_setzero_pd();
+      for (int i = 0; i < n; i += 8)
+      {
+         const __mmask8 m = TailAVX512(n - i);
+         const __m512d va = _mm512_maskz_loadu_pd(m, a + i);
+         __m512d vx = _mm512_sub_pd(_mm512_mul_pd(vlambda, va), _mm512_maskz_loadu_pd(m, c + i));
+         vx = _mm512_max_pd(_mm512_min_pd(vx, _mm512_maskz_loadu_pd(m, u + i)), _mm512_maskz_loadu_pd(m, l + i));
+         _mm512_mask_storeu_pd(x + i, m, vx);
+         vr = _mm512_add_pd(vr, _mm512_mul_pd(va, vx));
+      }
+      return _mm512_reduce_add_pd(vr);
+   }
+
+   __attribute__((target("avx512f")))
+   double StepAVX512(int n, double step, const double *x, const double *d, const double *t,
+                     const double *Qd, const double *f, double *xplus, double *tplus)
+   {
+      const __m512d vstep = _mm512_set1_pd(step);
+      const __m512d vhalf = _mm512_set1_pd(0.5);
+      __m512d vfv = _mm512_setzero_pd();
+      for (int i = 0; i < n; i += 8)
+      {
+         const __mmask8 m = TailAVX512(n - i);
+         const __m512d vx = _mm512_add_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_mul_pd(vstep, _mm512_maskz_loadu_pd(m, d + i)));
+         const __m512d vt = _mm512_add_pd(_mm512_maskz_loadu_pd(m, t + i), _mm512_mul_pd(vstep, _mm512_maskz_loadu_pd(m, Qd + i)));
+         _mm512_mask_storeu_pd(xplus + i, m, vx);
+         _mm512_mask_storeu_pd(tplus + i, m, vt);
+         vfv = _mm512_add_pd(vfv, _mm512_mul_pd(vx, _mm512_add_pd(_mm512_mul_pd(vhalf, vt), _mm512_maskz_loadu_pd(m, f + i))));
+      }
+      return _mm512_reduce_add_pd(vfv);
+   }
+
+   const PGMKernels avx512Kernels = {"avx512", AddScaledAVX512, DotAVX512, ProjectAVX512, StepAVX512};
+#endif
+
+
+   /** The widest kernels the CPU runs, the scalar ones without simd
+    */
+   const PGMKernels* SelectKernels(bool simd)
+   {
+#ifdef PGM_X86_KERNELS
+      if (simd)
+      {
+         __builtin_cpu_init();
+         if (__builtin_cpu_supports("avx512f"))
+            return &avx512Kernels;
+         if (__builtin_cpu_supports("avx"))
+            return &avxKernels;
+      }
+#endif
+      return &scalarKernels;
+   }
+}
+
+DaiFletcherPGM::DaiFletcherPGM(double lambda, const DualInnerSolverSettings& settings)
+   : DualInnerSolver(lambda, settings),
+     kernels(SelectKernels(settings.simd)),
      ipt(0),
      ipt2(0),
      uv(0),
@@ -46,22 +316,10 @@ DaiFletcherPGM::DaiFletcherPGM(double lambda)
      sk(0),
      yk(0)
 {
-   // default values
+   // default values, BMRM sets the tolerance before every solve
    tol = 1e-6;
-   maxProjIter = 200; 
-   maxPGMIter = 300000;
-
-   // synchronize members with configuration file
-   //   Configuration &config = Configuration::getInstance();
-  
-   // if(config.isSet("DaiFletcherPGM.maxProjIter"))
-   //   maxProjIter = config.getInt("DaiFletcherPGM.maxProjIter");
-
-   //if(config.isSet("DaiFletcherPGM.maxPGMIter"))
-   //  maxPGMIter = config.getInt("DaiFletcherPGM.maxPGMIter");
-   
-//    if(config.IsSet("DaiFletcherPGM.tolerance")) 
-//       tol = config.GetDouble("DaiFletcherPGM.tolerance");
+   maxProjIter = settings.maxProjIter; 
+   maxPGMIter = settings.maxPGMIter;
 
    
    // mem space required by dai-fletcher 
@@ -108,18 +366,7 @@ DaiFletcherPGM::~DaiFletcherPGM()
 double DaiFletcherPGM::ProjectR(double *x1, int n, double lambda, double *a1, 
                                       double b, double *c, double *l, double *u)
 {
-   register int i;
-   double r = 0.0;
-   
-   for (i = 0; i < n; i++)
-   {
-      x1[i] = -c[i] + lambda*a1[i];
-      if (x1[i] > u[i]) 
-         x1[i] = u[i];
-      else if(x1[i] < l[i]) 
-         x1[i] = l[i];
-      r += a1[i]*x1[i];
-   }
+   const double r = kernels->project(n, lambda, a1, c, l, u, x1);
    
    return (r - b);
 }
@@ -329,8 +576,7 @@ void DaiFletcherPGM::SolveQP()
       for (i = 0; i < it; i++)
       {
 	 tempQ = Q + ipt[i] * dim;
-	 for (j = 0; j < dim; j++)
-	    t[j] += (tempQ[j]*x[ipt[i]]);
+	 kernels->addScaled(dim, x[ipt[i]], tempQ, t);
       }
    }
    
@@ -378,12 +624,9 @@ void DaiFletcherPGM::SolveQP()
       
       projcount += ProjectDF(dim, a, *b, tempv, l, u, y, lam_ext);
       
-      gd = 0.0;
       for (i = 0; i < dim; i++)
-      {
         d[i] = y[i] - x[i];
-        gd  += d[i] * g[i];
-      }
+      gd = kernels->dot(dim, d, g);
       
       /* compute Qd = Q*d  or  Qd = Q*y - t depending on their sparsity */
       {
@@ -404,8 +647,7 @@ void DaiFletcherPGM::SolveQP()
             for (i = 0; i < it; i++)
             {
                tempQ = Q + ipt[i]*dim;
-               for (j = 0; j < dim; j++)
-                  Qd[j] += (tempQ[j] * d[ipt[i]]);
+               kernels->addScaled(dim, d[ipt[i]], tempQ, Qd);
             }
          }
          else          // compute Qd = Q*y-t
@@ -413,21 +655,15 @@ void DaiFletcherPGM::SolveQP()
             for (i = 0; i < it2; i++)
             {
                tempQ = Q + ipt2[i]*dim;
-               for (j = 0; j < dim; j++)
-                  Qd[j] += (tempQ[j] * y[ipt2[i]]);
+               kernels->addScaled(dim, y[ipt2[i]], tempQ, Qd);
             }
             for (j = 0; j < dim; j++)
                Qd[j] -= t[j];
          }
       }
       
-      ak = 0.0;
-      for (i = 0; i < dim; i++)
-         ak += d[i] * d[i];
-      
-      bk = 0.0;
-      for (i = 0; i < dim; i++)
-         bk += d[i]*Qd[i];
+      ak = kernels->dot(dim, d, d);
+      bk = kernels->dot(dim, d, Qd);
       
       if (bk > DaiFletcher::eps*ak && gd < 0.0)    // ak is normd
          lamnew = -gd/bk;
@@ -435,24 +671,12 @@ void DaiFletcherPGM::SolveQP()
          lamnew = 1.0;
       
       
-      fv = 0.0;
-      for (i = 0; i < dim; i++)
-      {
-         xplus[i] = x[i] + d[i];
-         tplus[i] = t[i] + Qd[i];
-         fv      += xplus[i] * (0.5*tplus[i] + f[i]);
-      }
+      fv = kernels->step(dim, 1.0, x, d, t, Qd, f, xplus, tplus);
       
       if ((innerIter == 1 && fv >= fv0) || (innerIter > 1 && fv >= fr))
       {
          lscount++;
-         fv = 0.0;
-         for (i = 0; i < dim; i++)
-         {
-            xplus[i] = x[i] + lamnew*d[i];
-            tplus[i] = t[i] + lamnew*Qd[i];
-            fv      += xplus[i] * (0.5*tplus[i] + f[i]);
-         }
+         fv = kernels->step(dim, lamnew, x, d, t, Qd, f, xplus, tplus);
       }
       
       for (i = 0; i < dim; i++)
@@ -484,12 +708,8 @@ void DaiFletcherPGM::SolveQP()
          }
       }
       
-      ak = bk = 0.0;
-      for (i = 0; i < dim; i++)
-      {
-         ak += sk[i] * sk[i];
-         bk += sk[i] * yk[i];
-      }
+      ak = kernels->dot(dim, sk, sk);
+      bk = kernels->dot(dim, sk, yk);
       
       if (bk <= DaiFletcher::eps*ak)
          alpha = DaiFletcher::alpha_max;
@@ -513,9 +733,7 @@ void DaiFletcherPGM::SolveQP()
       /*** stopping criterion based on KKT conditions ***/
       // at optimal, gradient of lagrangian w.r.t. x is zero
       
-      bk = 0.0;
-      for (i = 0; i < dim; i++)
-         bk +=  x[i] * x[i];
+      bk = kernels->dot(dim, x, x);
       
       
       if (sqrt(ak) < tol*10 * sqrt(bk))
@@ -586,7 +804,15 @@ void DaiFletcherPGM::SolveQP()
    
    
   Clean:;
-   // Verbosity removed
+   statistics.qpSolves++;
+   statistics.pgmIterations += (innerIter > maxPGMIter ? maxPGMIter : innerIter);
+   statistics.projections += projcount;
+}
+
+
+const char* DaiFletcherPGM::KernelName() const
+{
+   return kernels->name;
 }
 
 #endif
@@ -33,19 +33,28 @@ namespace DaiFletcher {
    const double tol_r = 1e-15;
 }
 
+/** The vector kernels of the solver, see daifletcherpgm.cpp
+ */
+struct PGMKernels;
+
 class DaiFletcherPGM : public DualInnerSolver 
 {
    public:      
-      DaiFletcherPGM(double lambda);      
+      DaiFletcherPGM(double lambda, const DualInnerSolverSettings& settings = DualInnerSolverSettings());      
       virtual ~DaiFletcherPGM();
       
       /** Solve the QP
        */
       virtual void SolveQP();
+
+      /** Name of the vector kernels in use: "avx512", "avx" or "scalar"
+       */
+      const char* KernelName() const;
       
    private: 
       int maxProjIter;
       int maxPGMIter;
+      const PGMKernels *kernels;
       int *ipt, *ipt2, *uv;
       double *g, *y, *tempv, *d, *Qd, *t, *xplus, *tplus, *sk, *yk;
       int *flag;
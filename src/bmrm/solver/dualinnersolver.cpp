@@ -24,29 +24,141 @@
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
 #include <vector>
 
 #include "utils/ublastools.hpp"
 #include "dualinnersolver.hpp"
 #include "utils/configuration.hpp"
+#include "utils/timer.hpp"
 
 #define AGG_GRAD_TIME_STAMP 99999
 #define INFTY     1e30
 #define ZERO_EPS  1e-16
 
+namespace
+{
+    /** Store the n entries of a in slot, converting them to T
+     */
+    template <class T>
+    void StoreEntries(T *slot, const double *a, size_t n)
+    {
+        for(size_t j=0; j < n; j++)
+            slot[j] = static_cast<T>(a[j]);
+    }
+
+
+    /** Row idx of the Gram matrix G with row length ld, against the first n
+     *  gradients of the bundle except skip, four gradients per pass over
+     *  gradient idx. The products are summed in element order.
+     */
+    template <class T>
+    void GramRow(const T *bundle, size_t size, int idx, int n, int skip, double scale, double lambda, double *G, int ld)
+    {
+        const T *g = bundle + idx*size;
+        int i = 0;
+        while(i < n)
+        {
+            int cols[4];
+            const T *h[4];
+            int m = 0;
+            for(; i < n && m < 4; i++)
+            {
+                if(i == skip) continue;
+                cols[m] = i;
+                h[m] = bundle + i*size;
+                m++;
+            }
+            
+            double sum[4] = {0.0, 0.0, 0.0, 0.0};
+            if(m == 4)
+            {
+                double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                for(size_t j=0; j < size; j++)
+                {
+                    const double gj = g[j];
+                    s0 += gj*h[0][j];
+                    s1 += gj*h[1][j];
+                    s2 += gj*h[2][j];
+                    s3 += gj*h[3][j];
+                }
+                sum[0] = s0; sum[1] = s1; sum[2] = s2; sum[3] = s3;
+            }
+            else
+            {
+                for(int k=0; k < m; k++)
+                {
+                    const T *hk = h[k];
+                    double sk = 0.0;
+                    for(size_t j=0; j < size; j++)
+                        sk += static_cast<double>(g[j])*hk[j];
+                    sum[k] = sk;
+                }
+            }
+            
+            for(int k=0; k < m; k++)
+            {
+                const double value = sum[k]*scale/lambda;
+                G[idx*ld + cols[k]] = value;
+                G[cols[k]*ld + idx] = value;
+            }
+        }
+    }
+
+
+    /** agg = (agg*xa + other*xo) * scale
+     */
+    template <class T>
+    void Combine(T *agg, const T *other, size_t n, double xa, double xo, double scale)
+    {
+        for(size_t j=0; j < n; j++)
+            agg[j] = static_cast<T>((agg[j]*xa + other[j]*xo)*scale);
+    }
+
+
+    /** w += weight * g
+     */
+    template <class T>
+    void AddScaled(double *w, const T *g, size_t n, double weight)
+    {
+        for(size_t j=0; j < n; j++)
+            w[j] += weight*g[j];
+    }
+
+
+#ifndef NDEBUG
+    template <class T>
+    double Dot(const T *a, const T *b, size_t n)
+    {
+        double value = 0.0;
+        for(size_t k=0; k < n; k++)
+            value += static_cast<double>(a[k])*b[k];
+        return value;
+    }
+#endif
+}
+
+
 // in general, BMRM needs more iterations to converge if we remove all IDLE gradients at once
 
-DualInnerSolver::DualInnerSolver(Real lambda)
+DualInnerSolver::DualInnerSolver(Real lambda, const DualInnerSolverSettings& settings)
    : InnerSolver(lambda),
      prevDim(0),
      f(0),
      Q(0),
+     G(0),
      a(0),
      b(0),
      l(0),
      u(0),
      tol(1e-6),
-     removeAllIdleGrad(false),
+     singlePrecision(settings.singlePrecision),
+     maxBundleBytes(settings.maxBundleBytes),
+     bundleLimit(settings.maxGradSetSize),
+     gradRows(0),
+     gradCols(0),
+     gradSize(0),
+     removeAllIdleGrad(settings.removeAllIdleGradients),
      QPScale(1.0),
      aggGradIdx(-1)
 {
@@ -55,30 +167,13 @@ DualInnerSolver::DualInnerSolver(Real lambda)
    dim = 0;
    numOfConstraint = 1;
    
-   // set (default) private member values
-   gradIdleAge = 9;
-   maxGradSetSize = 100;  // max num of gradients
-   
-   //AK Note : we should pass this options from cofi
-
-   // synchronize members with configuration file
-   //  Configuration &config = Configuration::getInstance();
-
-   //   if(config.isSet("DualInnerSolver.maxGradSetSize"))
-   //       maxGradSetSize = config.getInt("DualInnerSolver.maxGradSetSize");
-   
-   //    if(config.isSet("DualInnerSolver.gradIdleAge")) 
-   //    {
-   //        gradIdleAge = config.getInt("DualInnerSolver.gradIdleAge");
-   //        gradIdleAge = max(gradIdleAge, 2);
-   //    }
-   
-   //    if(config.isSet("DualInnerSolver.removeAllIdleGradients"))
-   //        removeAllIdleGrad = config.getIntAsBool("DualInnerSolver.removeAllIdleGradients");
-
+   // set private member values, the options are read by the caller
+   gradIdleAge = std::max(settings.gradIdleAge, 2);
+   maxGradSetSize = settings.maxGradSetSize;  // max num of gradients
+   assert(maxGradSetSize >= 2);
    
-   // pre-allocate memory for gradient, offset and active and enter time-stamps
-   gradientSet.resize(maxGradSetSize);                  
+   // pre-allocate memory for offset and active and enter time-stamps, the
+   // gradients are allocated as they come
    offsetSet.resize(maxGradSetSize,0);                  
    activeTimeStamp.resize(maxGradSetSize,0);  
    enterTimeStamp.resize(maxGradSetSize,0);   
@@ -86,6 +181,7 @@ DualInnerSolver::DualInnerSolver(Real lambda)
    // allocate maximum memory needed
    x = (double*)calloc(maxGradSetSize, sizeof(double));
    Q = (double*)calloc(maxGradSetSize*maxGradSetSize, sizeof(double));
+   G = (double*)calloc(maxGradSetSize*maxGradSetSize, sizeof(double));
    f = (double*)calloc(maxGradSetSize, sizeof(double));
    l = (double*)calloc(maxGradSetSize, sizeof(double));
    u = (double*)calloc(maxGradSetSize, sizeof(double));
@@ -102,21 +198,12 @@ DualInnerSolver::~DualInnerSolver()
     // free for parent
     if(x) free(x);
     if(Q) free(Q);
+    if(G) free(G);
     if(f) free(f);
     if(l) free(l);
     if(u) free(u);
     if(a) free(a);
     if(b) delete b;
-    
-    // Original
-    //    for(int i=0; i < dim; i++)
-    //    if(gradientSet[i])
-    //        delete gradientSet[i];   
-    
-    // AK Note : We have to check if this is ok !
-    for(int i=0; i < dim; i++)
-      gradientSet[i].resize(0,0);
-    // gradientSet[i].assign_temporary(ublas::matrix<Real>(0,0));
 }
 
 
@@ -130,20 +217,15 @@ void DualInnerSolver::Reset()
         l[i] = 0;
         u[i] = 1.0;
         a[i] = 1.0;      
-        // AK Note : We have to check if this is ok !
-	//gradientSet[i].assign_temporary(ublas::matrix<Real>(0,0));
-	gradientSet[i].resize(0,0);
-	// Original
-	//        if(gradientSet[i]) 
-        //{
-        //    delete gradientSet[i];
-        //    gradientSet[i] = 0;
-        //}
         offsetSet[i] = 0.0;
         activeTimeStamp[i] = 0;
         enterTimeStamp[i] = 0;
     }                
     memset(Q, 0, sizeof(double)*maxGradSetSize*maxGradSetSize); 
+    memset(G, 0, sizeof(double)*maxGradSetSize*maxGradSetSize); 
+
+    // the memory of the bundle is kept for the next gradients
+    gradRows = gradCols = gradSize = 0;
     
     // variables
     iter = 0;
@@ -153,9 +235,12 @@ void DualInnerSolver::Reset()
 
 void DualInnerSolver::Update(const ublas::matrix<Real>& a, const Real b)
 {
+    const double start = WallClock();
     iter++;
     int idx = 0;
     prevDim = dim;
+    if(gradSize == 0)
+        SetGradientShape(a);
 
     if(removeAllIdleGrad)
         idx = RemoveAllIdleGradients();
@@ -163,30 +248,15 @@ void DualInnerSolver::Update(const ublas::matrix<Real>& a, const Real b)
         idx = RemoveLaziestIdleGradient();
         
     
-    if(dim > maxGradSetSize)
+    if(dim > bundleLimit)
     {
-        dim = maxGradSetSize;
+        dim = bundleLimit;
         idx = AggregateGradients();
     }
-    else if(prevDim < dim)
-    {
-        // adjust memory area to fit a new column, if needed
-        int size = sizeof(double)*(dim-1);
-        for(int row=dim-2; row >= 1; row--)
-        {
-            double *src  = Q + (row*(dim-1));
-            double *dest = Q + (row*(dim-1))+ row;
-            memmove(dest, src, size);
-        }
-    }
+    // G keeps its row length, so a new gradient needs no room made for it
 
     prevDim = dim;
-    // AK Note : We need to check if this is ok !
-    //if(gradientSet[idx]) 
-    //    delete gradientSet[idx];
-    if(offsetSet[idx])
-      gradientSet[idx].resize(0,0);
-    gradientSet[idx] =  a;
+    StoreGradient(idx, a);
 
     offsetSet[idx] = b;
     
@@ -195,20 +265,7 @@ void DualInnerSolver::Update(const ublas::matrix<Real>& a, const Real b)
     activeTimeStamp[idx] = iter;  
 
     // update QP hessian matrix and vectors
-
-    // Insert row into Q
-    int theRow = idx*dim;
-    for(int i=0; i < dim; i++) 
-    {
-      double value = cofi::ublastools::inner_prod(gradientSet[idx], gradientSet[i]);
-      Q[theRow + i] = value*QPScale/lambda;
-    }
-      
-    // insert new column into Q[:,idx]
-    for(int i=0; i < dim; i++)
-    {
-        Q[i*dim + idx] = Q[theRow + i];
-    }
+    ComputeGramRow(idx, dim, -1);
     
     // update vectors      
     x[idx] = 0;
@@ -220,6 +277,81 @@ void DualInnerSolver::Update(const ublas::matrix<Real>& a, const Real b)
     MatrixCorrectnessCheck();
 #endif  
 
+    statistics.update += WallClock() - start;
+}
+
+
+void DualInnerSolver::SetGradientShape(const ublas::matrix<Real>& a)
+{
+    gradRows = a.size1();
+    gradCols = a.size2();
+    gradSize = gradRows*gradCols;
+
+    // keep as many gradients as fit into maxBundleBytes, but at least two
+    const size_t entryBytes = singlePrecision ? sizeof(float) : sizeof(double);
+    bundleLimit = maxGradSetSize;
+    if(maxBundleBytes > 0 && gradSize > 0)
+    {
+        const double fit = floor(maxBundleBytes/(gradSize*entryBytes));
+        if(fit < bundleLimit)
+            bundleLimit = std::max(static_cast<int>(fit), 2);
+    }
+
+    // reserve all of it up front, so that growing never over-allocates
+    if(singlePrecision)
+        singleBundle.reserve(bundleLimit*gradSize);
+    else
+        bundle.reserve(bundleLimit*gradSize);
+    statistics.peakBytes = std::max(statistics.peakBytes,
+            static_cast<double>(bundle.capacity()*sizeof(double) + singleBundle.capacity()*sizeof(float)));
+}
+
+
+void DualInnerSolver::StoreGradient(int idx, const ublas::matrix<Real>& a)
+{
+    assert(a.size1() == gradRows && a.size2() == gradCols);
+    assert(idx < bundleLimit);
+    const size_t end = (idx+1)*gradSize;
+    if(singlePrecision)
+    {
+        if(singleBundle.size() < end)
+            singleBundle.resize(end);
+        StoreEntries(&singleBundle[idx*gradSize], &(a.data()[0]), gradSize);
+    }
+    else
+    {
+        if(bundle.size() < end)
+            bundle.resize(end);
+        StoreEntries(&bundle[idx*gradSize], &(a.data()[0]), gradSize);
+    }
+}
+
+
+void DualInnerSolver::CopyGradient(int to, int from)
+{
+    if(singlePrecision)
+        memcpy(&singleBundle[to*gradSize], &singleBundle[from*gradSize], sizeof(float)*gradSize);
+    else
+        memcpy(&bundle[to*gradSize], &bundle[from*gradSize], sizeof(double)*gradSize);
+}
+
+
+void DualInnerSolver::CombineGradients(int idx, int j, double xi, double xj)
+{
+    const double scale = 1.0/(xi+xj);
+    if(singlePrecision)
+        Combine(&singleBundle[idx*gradSize], &singleBundle[j*gradSize], gradSize, xi, xj, scale);
+    else
+        Combine(&bundle[idx*gradSize], &bundle[j*gradSize], gradSize, xi, xj, scale);
+}
+
+
+void DualInnerSolver::ComputeGramRow(int idx, int n, int skip)
+{
+    if(singlePrecision)
+        GramRow(&singleBundle[0], gradSize, idx, n, skip, QPScale, lambda, G, maxGradSetSize);
+    else
+        GramRow(&bundle[0], gradSize, idx, n, skip, QPScale, lambda, G, maxGradSetSize);
 }
 
 
@@ -276,16 +408,9 @@ int DualInnerSolver::AggregateGradients()
     // aggregation of gradients
     
     if(fabs(x[aggGradIdx]) < ZERO_EPS)
-      { //AK Note : we need to check this !
+      {
         // swap aggGradIdx with idx
-        //if(gradientSet[aggGradIdx]) 
-      //   delete gradientSet[aggGradIdx];
-	if(offsetSet[aggGradIdx])
-	  gradientSet[aggGradIdx].resize(0,0);
-        gradientSet[aggGradIdx] = gradientSet[idx];
-        
-	//gradientSet[idx] = 0;
-	gradientSet[idx].resize(0,0);
+        CopyGradient(aggGradIdx, idx);
         
 	offsetSet[aggGradIdx] = offsetSet[idx];
         offsetSet[idx] = 0;
@@ -294,10 +419,7 @@ int DualInnerSolver::AggregateGradients()
     }
     else if(fabs(x[aggGradIdx]) > ZERO_EPS && fabs(x[idx] > ZERO_EPS))
       {
-	gradientSet[aggGradIdx] *= x[aggGradIdx];
-	gradientSet[idx] *= x[idx];      
-        gradientSet[aggGradIdx] += gradientSet[idx];
-        gradientSet[aggGradIdx] *= 1.0/(x[aggGradIdx]+x[idx]);
+        CombineGradients(aggGradIdx, idx, x[aggGradIdx], x[idx]);
 
         offsetSet[aggGradIdx] *= x[aggGradIdx];
         offsetSet[aggGradIdx] += x[idx]*offsetSet[idx];
@@ -308,16 +430,9 @@ int DualInnerSolver::AggregateGradients()
     // else, x[idx] == 0, do nothing
     
     // update the hessian matrix and vectors
-    for(int i=0; i<dim; i++)
-      {
-        // note that the entries Q[aggGradIdx][idx] and Q[idx][aggGradIdx] will be replaced correctly 
-        //  when new gradient take the position #idx#
-        if(i == idx) continue;
-        
-        double value = cofi::ublastools::inner_prod(gradientSet[aggGradIdx], gradientSet[i]);
-        Q[aggGradIdx*dim + i] = value*QPScale/lambda;
-        Q[i*dim + aggGradIdx] = Q[aggGradIdx*dim + i];
-      }
+    // note that the entries G[aggGradIdx][idx] and G[idx][aggGradIdx] will be replaced correctly 
+    //  when new gradient take the position #idx#
+    ComputeGramRow(aggGradIdx, dim, idx);
     
     f[aggGradIdx] = -offsetSet[aggGradIdx]*QPScale;     
     return idx;
@@ -341,10 +456,7 @@ int DualInnerSolver::RemoveAllIdleGradients()
         while((last_idle > 0) && (iter-activeTimeStamp[last_idle] >= gradIdleAge)) 
         {
             if(offsetSet[last_idle]) 
-	      {// AK Note : we need to check this !
-	      //delete gradientSet[last_idle];
-	      //gradientSet[last_idle] = 0;                                
-		gradientSet[last_idle].resize(0,0);
+	      {
 		offsetSet[last_idle] = 0;
                 x[last_idle] = 0;
                 f[last_idle] = 0; 
@@ -362,16 +474,8 @@ int DualInnerSolver::RemoveAllIdleGradients()
         // replace the top most to-remove gradient with the bottom most to-keep gradient
         if(first_idle < last_idle)
         {       
-            // 1. remove/replace the elements in gradientSet, offsetSet, x, f, activeTimeStamp                        
-          // AK Note : We need to check this !
-	  //if(gradientSet[first_idle]) 
-	  //    delete gradientSet[first_idle];
-	  if(offsetSet[first_idle])
-	    gradientSet[first_idle].resize(0,0);
-	  gradientSet[first_idle] = gradientSet[last_idle];
-            //gradientSet[last_idle] = 0;
-	    //gradientSet[last_idle].clear();
-	    //gradientSet[last_idle].resize(0,0);
+            // 1. remove/replace the elements in the bundle, offsetSet, x, f, activeTimeStamp                        
+            CopyGradient(first_idle, last_idle);
 	     
             offsetSet[first_idle] = offsetSet[last_idle];
             offsetSet[last_idle] = 0;
@@ -389,26 +493,20 @@ int DualInnerSolver::RemoveAllIdleGradients()
             enterTimeStamp[last_idle] = 0;
             
             // 2. memmove row                
-            memmove(Q+first_idle*dim, Q+last_idle*dim, sizeof(double)*dim);
+            memmove(G+first_idle*maxGradSetSize, G+last_idle*maxGradSetSize, sizeof(double)*dim);
             
             // 3. memmove column
             for(int i=0; i<last_idle; i++)
-                Q[i*dim + first_idle] = Q[i*dim + last_idle];                                
+                G[i*maxGradSetSize + first_idle] = G[i*maxGradSetSize + last_idle];                                
             
             // 4. one more to-remove gradient sink to the bottom
             removeCnt++;
         }
     }
     
-    // make the hessian matrix compact
-    if(removeCnt > 0)
-    {
-        assert(dim >= removeCnt);
-        
-        for(int i=1; i<dim; i++)
-            memmove(Q+i*(dim-removeCnt), Q+i*dim, sizeof(double)*(dim-removeCnt));
-        dim -= removeCnt;
-    }
+    // G keeps its row length, so the remaining rows stay where they are
+    assert(dim >= removeCnt);
+    dim -= removeCnt;
     dim++;
     
     return dim-1;  // i.e., use new slot
@@ -493,10 +591,19 @@ void DualInnerSolver::GetSolution(ublas::matrix<Real>& w, Real &objval)
     
 
     // Compute new w
+    assert(w.size1() == gradRows && w.size2() == gradCols);
     w.clear();
+    double *wData = &(w.data()[0]);
     for(int i=0; i < dim; i++)
+    {
       if(x[i] > threshold)
-	w += -x[i] * gradientSet[i];
+      {
+        if(singlePrecision)
+          AddScaled(wData, &singleBundle[i*gradSize], gradSize, -x[i]);
+        else
+          AddScaled(wData, &bundle[i*gradSize], gradSize, -x[i]);
+      }
+    }
 	 
     w *= factor;
 
@@ -540,8 +647,23 @@ void DualInnerSolver::Solve(ublas::matrix<Real>& w, const ublas::matrix<Real>& g
 {
     double w_dot_grad = cofi::ublastools::inner_prod(w, grad);
     Update(grad, loss - w_dot_grad);
+
+    double start = WallClock();
+    // pack Q for the QP solver
+    for(int i=0; i < dim; i++)
+        memcpy(Q + i*dim, G + i*maxGradSetSize, sizeof(double)*dim);
     SolveQP();
+    statistics.qp += WallClock() - start;
+
+    start = WallClock();
     GetSolution(w, objval);
+    statistics.solution += WallClock() - start;
+}
+
+
+void DualInnerSolver::AddCuttingPlane(const ublas::matrix<Real>& w, const ublas::matrix<Real>& grad, Real loss)
+{
+    Update(grad, loss - cofi::ublastools::inner_prod(w, grad));
 }
 
 
@@ -559,7 +681,9 @@ void DualInnerSolver::MatrixCorrectnessCheck()
     {
         for(int j=i; j < dim; j++)
         {
-	  double value = cofi::ublastools::inner_prod(gradientSet[i],gradientSet[j]);
+	  double value = singlePrecision
+	    ? Dot(&singleBundle[i*gradSize], &singleBundle[j*gradSize], gradSize)
+	    : Dot(&bundle[i*gradSize], &bundle[j*gradSize], gradSize);
 	  correctmat[i*dim + j] = QPScale*value/lambda;
 	  correctmat[j*dim + i] = correctmat[i*dim+j];
         }
@@ -567,9 +691,10 @@ void DualInnerSolver::MatrixCorrectnessCheck()
     
     for(int i=0; i < dim*dim; i++)
     {
-        if(fabs(correctmat[i] - Q[i]) > 1e-15) 
+        const double entry = G[(i/dim)*maxGradSetSize + i%dim];
+        if(fabs(correctmat[i] - entry) > 1e-15) 
         {
-            std::clog << "residual : " << fabs(correctmat[i] - Q[i]) << std::endl;
+            std::clog << "residual : " << fabs(correctmat[i] - entry) << std::endl;
             std::clog << "Q matrix update correctness check : i = " << i << ", correct Q[i] = " << correctmat[i] << std::endl;
             std::clog << "ERROR: Q matrix is incorrect ! " << std::endl;
             exit(EXIT_FAILURE);
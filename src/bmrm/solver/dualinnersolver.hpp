@@ -11,6 +11,27 @@ namespace DualSolver
 }
 
 
+/**
+ * The options of DualInnerSolver and DaiFletcherPGM. The defaults are the
+ * values the solvers were hard coded to.
+ */
+struct DualInnerSolverSettings
+{
+    int maxGradSetSize;          // DualInnerSolver.maxGradSetSize
+    int gradIdleAge;             // DualInnerSolver.gradIdleAge
+    bool removeAllIdleGradients; // DualInnerSolver.removeAllIdleGradients
+    double maxBundleBytes;       // DualInnerSolver.maxBundleMB, 0 for no bound
+    bool singlePrecision;        // DualInnerSolver.singlePrecision
+    int maxProjIter;             // DaiFletcherPGM.maxProjIter
+    int maxPGMIter;              // DaiFletcherPGM.maxPGMIter
+    bool simd;                   // DaiFletcherPGM.simd
+
+    DualInnerSolverSettings()
+        : maxGradSetSize(100), gradIdleAge(9), removeAllIdleGradients(false), maxBundleBytes(0),
+          singlePrecision(false), maxProjIter(200), maxPGMIter(300000), simd(false) {}
+};
+
+
 /** 
  *   when \Omega = 0.5|w|_2^2, the dual of the problem can be solved instead of the primal.
  */
@@ -30,9 +51,15 @@ protected:
      */
     double *f;
     
-    /** Hessian matrix of the objective function
+    /** Hessian matrix of the objective function, dim x dim, as passed to SolveQP()
      */
     double *Q;
+
+    /** Gram matrix of the gradients, scaled like Q, with the fixed row length
+     *  maxGradSetSize. Gradients enter and leave it without moving the rows of
+     *  the others; Q is packed from it before every SolveQP().
+     */
+    double *G;
     
     /** Constraint matrix
      */
@@ -54,9 +81,35 @@ protected:
      */
     double tol;
     
-    /** Gradient set
+    /** Gradient set: gradient i is stored contiguously, row major, at
+     *  bundle[i*gradSize], i.e. the gradients are the columns of a
+     *  gradSize x bundleLimit column major matrix. With singlePrecision,
+     *  singleBundle holds them instead.
+     */
+    std::vector<double> bundle;
+    std::vector<float> singleBundle;
+
+    /** Whether the gradients are stored in single precision. All arithmetic
+     *  on them is still done in double precision.
+     *  [default: false]
      */
-  std::vector<ublas::matrix<Real> >  gradientSet;
+    bool singlePrecision;
+
+    /** Bound on the bytes of the stored gradients, 0 for none
+     *  [default: 0]
+     */
+    double maxBundleBytes;
+
+    /** Maximum number of gradients to keep for the current problem:
+     *  maxGradSetSize, less if that many would exceed maxBundleBytes.
+     */
+    int bundleLimit;
+
+    /** Number of rows, columns and entries of the gradients
+     */
+    size_t gradRows;
+    size_t gradCols;
+    size_t gradSize;
     
     /** Offsets set
      */
@@ -84,7 +137,7 @@ protected:
     /** Maximum number of gradients to keep in gradientSet.
      *  Once the number of gradients exceeds this, oldest gradients 
      *  will be "aggregated" into one.
-     *  [default: 1000]
+     *  [default: 100]
      */
     int maxGradSetSize;
     
@@ -102,6 +155,34 @@ protected:
     /** index for aggregated gradient
      */
     int aggGradIdx;
+
+    /** Time spent in Update(), SolveQP() and GetSolution(), and the
+     *  memory of the gradients
+     */
+    BundleStatistics statistics;
+
+    /** Take the shape of the gradients from a, and bound and reserve the
+     *  bundle for it
+     */
+    void SetGradientShape(const ublas::matrix<Real>& a);
+
+    /** Store gradient a at position idx of the gradient set
+     */
+    void StoreGradient(int idx, const ublas::matrix<Real>& a);
+
+    /** Copy gradient from to position to of the gradient set
+     */
+    void CopyGradient(int to, int from);
+
+    /** Replace gradient idx by the combination (xi*gi + xj*gj)/(xi + xj)
+     *  of itself and gradient j
+     */
+    void CombineGradients(int idx, int j, double xi, double xj);
+
+    /** Compute row idx of G, the inner products of gradient idx with the
+     *  first n gradients except skip, in one pass over the bundle
+     */
+    void ComputeGramRow(int idx, int n, int skip);
     
     /** Solve QP
      */
@@ -148,7 +229,7 @@ public:
     
   /** Constructor
    */
-  DualInnerSolver(Real lambda);      
+  DualInnerSolver(Real lambda, const DualInnerSolverSettings& settings = DualInnerSolverSettings());      
   
     
   /** Destructor
@@ -159,6 +240,11 @@ public:
   /** Solve the problem
    */
   virtual void Solve(ublas::matrix<Real>& w, const ublas::matrix<Real>& grad, Real loss, Real &objval);
+
+
+  /** Add the cutting plane of the loss at w to the bundle
+   */
+  virtual void AddCuttingPlane(const ublas::matrix<Real>& w, const ublas::matrix<Real>& grad, Real loss);
     
 
   /** Compute the value of regularizer
@@ -179,6 +265,21 @@ public:
    *  the whole problem can be solved in much less number of iterations
    */
   virtual void SetTolerance(const Real &theTolerance) {tol = theTolerance;}
+
+
+  /** Add the time spent in Update(), SolveQP() and GetSolution(), and
+   *  the memory of the gradients
+   */
+  virtual void AddStatistics(BundleStatistics& s) const
+  {
+      s.update += statistics.update;
+      s.qp += statistics.qp;
+      s.solution += statistics.solution;
+      s.peakBytes = std::max(s.peakBytes, statistics.peakBytes);
+      s.qpSolves += statistics.qpSolves;
+      s.pgmIterations += statistics.pgmIterations;
+      s.projections += statistics.projections;
+  }
 };
 
 #endif
@@ -20,6 +20,7 @@
 #ifndef _INNERSOLVER_HPP_
 #define _INNERSOLVER_HPP_
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -27,6 +28,40 @@
 #include "core/types.hpp"
 
 
+/**
+ * Wall clock seconds spent in the phases of the bundle method, and the
+ * memory of its gradients.
+ */
+struct BundleStatistics
+{
+    double loss;      // Computing the loss and its gradient
+    double update;    // Adding a gradient to the bundle and its Gram matrix
+    double qp;        // Solving the QP
+    double solution;  // Computing w from the solution of the QP
+    double peakBytes; // The largest memory held by the stored gradients
+    double iterations;// The number of evaluations of the loss
+    double qpSolves;  // The number of QPs solved
+    double pgmIterations; // The iterations of the projected gradient method over all QPs
+    double projections;   // The iterations of the projections over all QPs
+
+    BundleStatistics() : loss(0), update(0), qp(0), solution(0), peakBytes(0), iterations(0),
+                         qpSolves(0), pgmIterations(0), projections(0) {}
+
+    void add(const BundleStatistics& other)
+    {
+        iterations += other.iterations;
+        loss += other.loss;
+        update += other.update;
+        qp += other.qp;
+        solution += other.solution;
+        peakBytes = std::max(peakBytes, other.peakBytes);
+        qpSolves += other.qpSolves;
+        pgmIterations += other.pgmIterations;
+        projections += other.projections;
+    }
+};
+
+
 /** 
  * Abstract class for representing an inner solver which solves the
  * following type of mathematcal program:  
@@ -106,6 +141,21 @@ public:
      *  Meaningful for those solvers which store past gradients
      */
     virtual void Reset(){};
+
+    /** Add the cutting plane of the loss at w to the bundle without solving
+     *  the QP. Meaningful for those solvers which store past gradients
+     *
+     *  @param w [read] the point the loss was evaluated at
+     *  @param grad [read] the gradient of the loss at w
+     *  @param loss [read] the loss at w
+     */
+    virtual void AddCuttingPlane(const ublas::matrix<Real>& w, const ublas::matrix<Real>& grad, Real loss) {}
+
+    /** Add the time spent in the phases of the inner solver and its memory
+     *
+     *  @param statistics [r/w] the statistics to add to
+     */
+    virtual void AddStatistics(BundleStatistics& statistics) const {}
 };
 
 #endif
@@ -0,0 +1,85 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "subgradient.hpp"
+
+#include <cmath>
+
+#include "utils/timer.hpp"
+
+
+Subgradient::Subgradient(LossFunction& lossFunction, const Real lambda) :
+lossFunction(lossFunction), lambda(lambda), initialStepSize(0.01), minRelativeProgress(1e-3), maxIter(100), lossTime(0), evaluations(0) {
+}
+
+
+void Subgradient::setConvergence(const double initialStepSize, const double minRelativeProgress, const int maxIter) {
+    this->initialStepSize = initialStepSize;
+    this->minRelativeProgress = minRelativeProgress;
+    this->maxIter = maxIter;
+}
+
+
+void Subgradient::addStatistics(BundleStatistics& statistics) const {
+    statistics.iterations += evaluations;
+    statistics.loss += lossTime;
+}
+
+
+Real Subgradient::train(ublas::matrix<Real>& w) {
+    ublas::matrix<Real> gradient(w.size1(), w.size2());
+    ublas::matrix<Real> best(w);
+    // The steps are relative to the scale of the start
+    const Real scale = initialStepSize * (ublas::norm_frobenius(w) + 1.0);
+    Real bestJ = 0.0;
+    Real bestLoss = 0.0;
+    Real checkedJ = 0.0; // bestJ CHECK_INTERVAL iterations ago
+
+    for (int iter = 0; iter < maxIter; ++iter) {
+        Real loss = 0.0;
+        const double start = WallClock();
+        lossFunction.ComputeLossGradient(w, loss, gradient);
+        lossTime += WallClock() - start;
+        evaluations++;
+        const Real norm = ublas::norm_frobenius(w);
+        const Real J = loss + 0.5 * lambda * norm * norm;
+
+        if (iter == 0 || J < bestJ) {
+            bestJ = J;
+            bestLoss = loss;
+            best = w;
+        }
+        if (iter == 0) {
+            checkedJ = bestJ;
+        } else if (iter % CHECK_INTERVAL == 0) {
+            if ((checkedJ - bestJ) / std::fabs(bestJ) < minRelativeProgress) {
+                break;
+            }
+            checkedJ = bestJ;
+        }
+
+        // w -= eta_t * G / |G| for the subgradient G = gradient + lambda * w
+        gradient += lambda * w;
+        const Real gradientNorm = ublas::norm_frobenius(gradient);
+        if (gradientNorm == 0.0) {
+            break;
+        }
+        const Real eta = scale / std::sqrt(iter + 1.0);
+        w -= (eta / gradientNorm) * gradient;
+    }
+    w = best;
+    return bestLoss;
+}
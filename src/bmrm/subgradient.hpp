@@ -0,0 +1,76 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _SUBGRADIENT_HPP_
+#define _SUBGRADIENT_HPP_
+
+#include "core/types.hpp"
+#include "lossfunction.hpp"
+#include "solver/innersolver.hpp"
+
+/**
+ * The subgradient method on the regularized risk
+ *
+ *   J(w) = loss(w) + lambda/2 |w|^2
+ *
+ * with normalized steps of length eta (|w_0| + 1) / sqrt(t + 1). It keeps no
+ * bundle and solves no QP, and returns the best iterate seen.
+ */
+class Subgradient {
+public:
+    Subgradient(LossFunction& lossFunction, const Real lambda);
+
+    /**
+     * Minimizes J starting from w. The loss is only ever evaluated at w
+     * itself.
+     *
+     * @param w [r/w] the start and the solution.
+     * @return the loss at the solution.
+     */
+    Real train(ublas::matrix<Real>& w);
+
+    /**
+     * @param initialStepSize eta, the length of the first step relative to
+     *        the norm of the start.
+     * @param minRelativeProgress stop once the best J decreases by less than
+     *        this fraction over CHECK_INTERVAL iterations.
+     * @param maxIter the maximum number of iterations.
+     */
+    void setConvergence(const double initialStepSize, const double minRelativeProgress, const int maxIter);
+
+    /**
+     * Adds the time spent in the loss and the number of its evaluations to
+     * statistics.
+     */
+    void addStatistics(BundleStatistics& statistics) const;
+
+    /**
+     * The number of iterations the progress is measured over.
+     */
+    static const int CHECK_INTERVAL = 10;
+
+private:
+    LossFunction& lossFunction;
+    const Real lambda;
+    double initialStepSize;
+    double minRelativeProgress;
+    int maxIter;
+
+    double lossTime;
+    size_t evaluations;
+};
+
+#endif /* _SUBGRADIENT_HPP_ */
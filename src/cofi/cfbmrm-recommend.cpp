@@ -0,0 +1,200 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+// Standard
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+
+
+// Our Code
+#include "core/types.hpp"
+#include "core/cofiexception.hpp"
+#include "io/modelio.hpp"
+#include "io/svmlightloader.hpp"
+#include "cofi/recommender.hpp"
+#include "cofi/itemindex.hpp"
+#include "cofi/foldin.hpp"
+#include "io/bufferedwriter.hpp"
+#include "utils/timer.hpp"
+
+
+namespace {
+
+    size_t numberOfProcessors(void) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        return online > 0 ? static_cast<size_t> (online) : 1;
+    }
+
+
+    void writeRecommendations(cofi::io::BufferedWriter& out, const std::vector<cofi::Recommendation>& r) {
+        for (size_t j = 0; j < r.size(); ++j) {
+            // +1, as the files all start with column 1
+            out.writeIndex(r[j].item + 1);
+            out.write(':');
+            out.writeReal(r[j].score);
+            out.write(' ');
+        }
+        out.write('\n');
+    }
+
+
+    /**
+     * Computes the top k items per user from a model stored by cofirank with
+     * cofi.storeModel:
+     *
+     *   cofirank-recommend MODEL K OUTFILE [EXCLUDEFILE [THREADS [LISTS PROBES]]]
+     *
+     * The items a user has in EXCLUDEFILE, typically the training data, are
+     * not recommended to that user. THREADS defaults to one per processor.
+     * With LISTS > 0, the items are searched approximately in an ItemIndex
+     * with LISTS lists, PROBES of which are searched per user.
+     */
+    void recommend(int argc, char **argv) {
+        const std::string modelFile(argv[1]);
+        const size_t k = static_cast<size_t> (atoi(argv[2]));
+        const std::string outFile(argv[3]);
+        size_t nThreads = argc > 5 ? static_cast<size_t> (atoi(argv[5])) : 0;
+        if (nThreads == 0) {
+            nThreads = numberOfProcessors();
+        }
+
+        cofi::UType U;
+        cofi::MType M;
+        if (!cofi::io::loadModelMatrix(modelFile, "U", U) || !cofi::io::loadModelMatrix(modelFile, "M", M)) {
+            throw cofi::CoFiException("The model lacks U or M: " + modelFile);
+        }
+        std::clog << "Loaded " << U.size1() << " users and " << M.size1() << " items from " << modelFile << std::endl;
+
+        cofi::Recommender recommender(U, M);
+        cofi::DType excluded;
+        if (argc > 4) {
+            cofi::io::CSRData data;
+            cofi::io::loadSVMLight(argv[4], data, nThreads);
+            data.moveTo(excluded, data.size1(), std::max(data.size2(), M.size1()));
+            recommender.setExcluded(&excluded);
+        }
+
+        const size_t nLists = argc > 7 ? static_cast<size_t> (atoi(argv[6])) : 0;
+        const cofi::ItemIndex* index = NULL;
+        if (nLists > 0) {
+            index = new cofi::ItemIndex(M, nLists, cofi::ItemIndex::DEFAULT_ITERATIONS, nThreads);
+            std::clog << "Built an index with " << index->getNumberOfLists() << " lists" << std::endl;
+            recommender.setIndex(index, static_cast<size_t> (atoi(argv[7])));
+        }
+        recommender.store(k, outFile, nThreads);
+        delete index;
+    }
+
+
+    /**
+     * Folds the users of RATINGSFILE into a model stored by cofirank with
+     * cofi.storeModel:
+     *
+     *   cofirank-recommend --foldin MODEL K RATINGSFILE OUTFILE
+     *
+     * The features of the users are written to OUTFILE.lsvm, their top k
+     * items among the ones they have not rated to OUTFILE. Ratings of items
+     * that are not in the model are skipped with a warning.
+     */
+    void foldIn(int argc, char **argv) {
+        const std::string modelFile(argv[2]);
+        const size_t k = static_cast<size_t> (atoi(argv[3]));
+        const std::string outFile(argv[5]);
+
+        cofi::MType M;
+        ublas::matrix<Real> settings;
+        if (!cofi::io::loadModelMatrix(modelFile, "M", M) || !cofi::io::loadModelMatrix(modelFile, "settings", settings)) {
+            throw cofi::CoFiException("The model lacks M or the settings: " + modelFile);
+        }
+        cofi::io::CSRData ratings;
+        cofi::io::loadSVMLight(argv[4], ratings, numberOfProcessors());
+        std::clog << "Folding " << ratings.size1() << " users into " << M.size1() << " items from " << modelFile << std::endl;
+
+        cofi::FoldIn foldIn(M, cofi::FoldInSettings::fromMatrix(settings));
+        cofi::io::BufferedWriter topK(outFile);
+        cofi::io::BufferedWriter features(outFile + ".lsvm");
+        std::vector<cofi::itemid> items;
+        std::vector<Real> values;
+        cofi::WType u;
+        std::vector<cofi::Recommendation> result;
+        size_t skippedRatings = 0;
+        size_t skippedUsers = 0;
+        const double start = WallClock();
+        for (size_t user = 0; user < ratings.size1(); ++user) {
+            const size_t begin = ratings.rowStart()[user];
+            const size_t end = ratings.rowStart()[user + 1];
+            items.clear();
+            values.clear();
+            for (size_t e = begin; e < end; ++e) {
+                if (ratings.columns()[e] < M.size1()) {
+                    items.push_back(ratings.columns()[e]);
+                    values.push_back(ratings.values()[e]);
+                }
+            }
+            if (items.size() < end - begin) {
+                skippedRatings += end - begin - items.size();
+                ++skippedUsers;
+            }
+            foldIn.solve(items, values, u);
+            foldIn.recommend(u, items, k, result);
+
+            for (size_t d = 0; d < u.size1(); ++d) {
+                if (u(d, 0) == 0) continue;
+                features.writeIndex(d + 1);
+                features.write(':');
+                features.writeReal(u(d, 0));
+                features.write(' ');
+            }
+            features.write('\n');
+            writeRecommendations(topK, result);
+        }
+        const double elapsed = WallClock() - start;
+        if (skippedRatings > 0) {
+            std::clog << "WARNING: Skipped " << skippedRatings << " ratings of " << skippedUsers
+                    << " users for items that are not in the model" << std::endl;
+        }
+        std::clog << "Folded in " << ratings.size1() << " users in " << elapsed << "s, "
+                << (ratings.size1() > 0 ? 1000.0 * elapsed / ratings.size1() : 0.0) << "ms per user" << std::endl;
+        features.close();
+        topK.close();
+    }
+}
+
+
+int main(int argc, char **argv) {
+    const bool folding = argc > 1 && std::string(argv[1]) == "--foldin";
+    if ((folding && argc < 6) || argc < 4) {
+        std::cout << "Usage: " << argv[0] << " MODEL K OUTFILE [EXCLUDEFILE [THREADS [LISTS PROBES]]]" << std::endl;
+        std::cout << "       " << argv[0] << " --foldin MODEL K RATINGSFILE OUTFILE" << std::endl;
+        return -1;
+    }
+    try {
+        if (folding) {
+            foldIn(argc, argv);
+        } else {
+            recommend(argc, argv);
+        }
+        std::clog << "Done!" << std::endl;
+    } catch (cofi::CoFiException& e) {
+        std::cerr << "A cofi exception occurred: " << e.describe() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -43,14 +43,27 @@ bool assertionsEnabled(void) {
 }
 
 
+/**
+ * Points std::clog to another buffer for as long as it lives. std::clog must
+ * not be left pointing to the buffer of a file that is already closed, which
+ * would crash the flush of std::clog at exit.
+ */
+class ClogRedirect {
+public:
+    ClogRedirect(std::streambuf* buffer) : previous(std::clog.rdbuf(buffer)) {}
+    ~ClogRedirect(void) { std::clog.rdbuf(previous); }
+private:
+    std::streambuf* previous;
+};
+
+
 /**
  * The main method of cofirank. It does a number of things:
  * (1) Read the default config.
  * (2) Read the user submitted config
  * (3) Setup logging into a file "clog.txt" in the output folder
  * (4) Instanciate the Problem and COFIBMRM objects
- * (5) Train the system
- * (6) If configured, save the resulting matrices to the output folder
+ * (5) Train the system, which saves the model to the output folder if configured
  */
 int main(int argc, char **argv) {
     std::string outFolder = "./";
@@ -73,7 +86,7 @@ int main(int argc, char **argv) {
         running.close();
         std::clog << "All output including logs will go to " << outFolder << std::endl;
         std::ofstream clogOut((outFolder + "clog.txt").c_str());
-        std::clog.rdbuf(clogOut.rdbuf());
+        ClogRedirect redirect(clogOut.rdbuf());
         std::clog << "Starting up" << std::endl;
         std::clog << "Configuration file used: " << configFileName << std::endl;
         assert(assertionsEnabled());
@@ -83,16 +96,6 @@ int main(int argc, char **argv) {
         cofi::Problem p;
         cofi::COFIBMRM b(p);
         b.train();
-        if (conf.getInt("cofi.storeModel") == 1) {
-            cofi::io::storeMatrix(p.getU(), outFolder + "U.lsvm");
-            cofi::io::storeMatrix(p.getM(), outFolder + "M.lsvm");
-            //                cofi::io::storeMatrix(p.getA(), outFolder + cofi::Cofi::AFileName);
-            //                cofi::io::storeMatrix(p.getS(), outFolder + cofi::Cofi::SFileName);
-        }
-        if (conf.getInt("cofi.storeF") == 1) {
-            cofi::io::storeMatrix(prod(p.getU(), trans(p.getM())), outFolder + "F.lsvm");
-        }
-
 
         // Store the configuration and log its useage statistics
         conf.writeUsageStatistics(std::clog);
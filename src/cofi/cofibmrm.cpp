@@ -40,7 +40,7 @@ namespace cofi {
     public:
 
 
-        ObjectiveEvaluator(void) : ofVal(0), uLambda(0), mLambda(0), uLoss(0), mLoss(0), uNorm(0), mNorm(0) {
+        ObjectiveEvaluator(void) : ofVal(0), uLambda(0), mLambda(0), uLoss(0), mLoss(0), uNorm(0), mNorm(0), uIterations(0), mIterations(0) {
         };
 
 
@@ -60,6 +60,8 @@ namespace cofi {
             result.push_back("movieLoss");
             result.push_back("movieLambda");
             result.push_back("movieNorm");
+            result.push_back("userIterations");
+            result.push_back("movieIterations");
             return result;
         }
 
@@ -79,6 +81,8 @@ namespace cofi {
             results["movieLoss"] = mLoss;
             results["movieLambda"] = mLambda;
             results["movieNorm"] = mNorm;
+            results["userIterations"] = uIterations;
+            results["movieIterations"] = mIterations;
         }
 
         Real ofVal;
@@ -88,6 +92,8 @@ namespace cofi {
         Real mLoss;
         Real uNorm;
         Real mNorm;
+        Real uIterations; // BMRM iterations per user, or of the joint solve with the graph kernel
+        Real mIterations; // BMRM iterations of the movie phase
     };
 
 }
@@ -206,6 +212,13 @@ void cofi::COFIBMRM::train(void) {
         ofEval->uLoss = uLoss;
         ofEval->uLambda = userLambda;
         ofEval->uNorm = uNorm;
+        // With the graph kernel the user phase is a single joint solve.
+        if (p.usingGraphKernel()) {
+            ofEval->uIterations = userPhase.getStatistics().iterations;
+        } else {
+            ofEval->uIterations = userPhase.getStatistics().iterations / p.getNumberOfUsers();
+        }
+        ofEval->mIterations = moviePhase.getStatistics().iterations;
 
 #ifndef NDEBUG
         if (p.usingMovieOffset()) {
@@ -226,6 +239,7 @@ void cofi::COFIBMRM::train(void) {
         eval.eval(p);
 
     }// Main loop
+    eval.flush();
     out.close();
 
     p.save("weak");
@@ -237,12 +251,14 @@ void cofi::COFIBMRM::train(void) {
         CSVFileEvaluator strongEval(strongOut);
         strongEval.registerConfiguredEvaluators();
         std::clog << "COFIBMRM: User Strong Generalization Phase started" << std::endl;
+        userPhase.resetWarmStart();
         const Real uLoss = userPhase.run(p, 1, userLambda); // TODO: 1 is the wrong iteration conter here...
         const Real uNorm = norm_frobenius(p.getU());
         this->userLosses.push_back(uLoss);
         this->userNorms.push_back(uNorm);
         std::clog << "COFIBMRM: Strong UserPhase finished with a loss of " << uLoss << " and a norm of " << uNorm << std::endl;
         strongEval.eval(p);
+        strongEval.flush();
         strongOut.close();
         p.save("strong");
     }
@@ -37,41 +37,50 @@ cofi::BinaryEvaluator::~BinaryEvaluator(void){
     
 }
 
-void cofi::BinaryEvaluator::eval(cofi::UserIterator& iter, std::map<std::string, double>& results){
+void cofi::BinaryEvaluator::begin(const cofi::UserIterator::Phase phase, const size_t nUsers){
+    const Counts zero = {0, 0, 0, 0, 0, 0};
+    counts.assign(nUsers, zero);
+}
+
+void cofi::BinaryEvaluator::evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& f){
+    assert(Y.size1() == f.size1());
+    Counts& c = counts[user];
+    for(size_t i=0; i<Y.size1(); ++i){
+        if(f(i, 0) < 0){
+            c.predictedNegatives += 1;
+        }
+        else{
+            c.predictedPositives += 1;
+        }
+        
+        if(f(i, 0) < 0 && Y(i, 0) >= 0){
+            c.falseNegatives += 1;
+        }
+        else if(f(i, 0) >= 0 && Y(i, 0) < 0){
+            c.falsePositives += 1;
+        }
+        else{
+            c.correct += 1;
+        }
+        c.all += 1;
+    }
+}
+
+void cofi::BinaryEvaluator::finish(std::map<std::string, double>& results){
     unsigned int falsePositives = 0;
     unsigned int falseNegatives = 0;
     unsigned int predictedPositives = 0;
     unsigned int predictedNegatives = 0;
     unsigned int correct = 0;
     unsigned int all = 0;
-    while (iter.hasNext()) {
-        
-        iter.advance();
-        ublas::matrix<Real>& Y = iter.getY();
-        ublas::matrix<Real> f = ublas::matrix<Real>(Y.size1(), Y.size2());
-        iter.predict(f);
-        assert(Y.size1() == f.size1());
-        
-        for(size_t i=0; i<Y.size1(); ++i){
-            if(f(i, 0) < 0){
-                predictedNegatives += 1;
-            }
-            else{
-                predictedPositives += 1;
-            }
-            
-            if(f(i, 0) < 0 && Y(i, 0) >= 0){
-                falseNegatives += 1;
-            }
-            else if(f(i, 0) >= 0 && Y(i, 0) < 0){
-                falsePositives += 1;
-            }
-            else{
-                correct += 1;
-            }
-            all += 1;
-        }
-        
+    for(size_t user=0; user<counts.size(); ++user){
+        const Counts& c = counts[user];
+        falsePositives += c.falsePositives;
+        falseNegatives += c.falseNegatives;
+        predictedPositives += c.predictedPositives;
+        predictedNegatives += c.predictedNegatives;
+        correct += c.correct;
+        all += c.all;
     }
     
     assert(falsePositives + falseNegatives + correct == all);
@@ -51,7 +51,23 @@ namespace cofi{
          */
         std::vector<std::string> names(void);
 
-        void eval(cofi::UserIterator& iter, std::map<std::string, double>& results);
+        void begin(const cofi::UserIterator::Phase phase, const size_t nUsers);
+        void evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& F);
+        void finish(std::map<std::string, double>& results);
+
+    private:
+        /**
+         * The counts of one user
+         */
+        struct Counts {
+            unsigned int falsePositives;
+            unsigned int falseNegatives;
+            unsigned int predictedPositives;
+            unsigned int predictedNegatives;
+            unsigned int correct;
+            unsigned int all;
+        };
+        std::vector<Counts> counts;
     };
 }
 #endif
@@ -23,6 +23,7 @@
 
 #include "core/types.hpp"
 #include "cofi/problem.hpp"
+#include "cofi/useriterator.hpp"
 
 
 /**
@@ -40,11 +41,30 @@ namespace cofi{
         virtual std::vector<std::string> names(void) = 0;
         
         /**
-         * Evaluates based on current state of problem and writes to the stream.
-         * @param iter the iterator over the data to evaluate on.
-         * @return the evaluation result.
+         * Starts an evaluation over the given number of users.
+         *
+         * @param phase the data set the users are taken from. Its ratings do
+         *        not change over the lifetime of the evaluator.
+         * @param nUsers the number of users evalUser() will be called for.
          */
-        virtual void eval(cofi::UserIterator& iter, std::map<std::string, double>& results)=0;
+        virtual void begin(const cofi::UserIterator::Phase phase, const size_t nUsers) = 0;
+
+        /**
+         * Evaluates the predictions of one user. Called once for every user
+         * between begin() and finish(), concurrently for different users.
+         *
+         * @param user the row of the user in D.
+         * @param Y the ratings of the user.
+         * @param F the predictions for these ratings.
+         */
+        virtual void evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& F) = 0;
+
+        /**
+         * Combines the users in the order of their ids into the results.
+         *
+         * @param results the evaluation results, keyed by names().
+         */
+        virtual void finish(std::map<std::string, double>& results) = 0;
 
         
     };
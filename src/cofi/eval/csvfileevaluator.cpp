@@ -17,8 +17,7 @@
 
 #include <string>
 #include <vector>
-#include <vector>
-#include <vector>
+#include <exception>
 
 #include "csvfileevaluator.hpp"
 #include "ndcgevaluator.hpp"
@@ -27,13 +26,106 @@
 #include "normevaluator.hpp"
 #include "meansquarederror.hpp"
 #include "utils/configuration.hpp"
+#include "utils/parallel.hpp"
+#include "utils/timer.hpp"
+#include "core/cofiexception.hpp"
+#include "cofi/useriterator.hpp"
 
 const static std::string s = " , ";
 
 using std::string;
 using std::map;
 
-cofi::CSVFileEvaluator::CSVFileEvaluator(std::ostream& out):headerWritten(false), out(out){}// Constructor
+namespace {
+
+    /**
+     * Predicts the ratings of each user once and hands them to all the
+     * data dependent evaluators.
+     *
+     * Each worker thread gets its own UserIterator and prediction buffer.
+     * The evaluators keep their results per user and combine them in
+     * finish(), such that the result does not depend on the number of
+     * threads.
+     */
+    class EvaluationTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        EvaluationTask(cofi::Problem& p, const cofi::UserIterator::Phase phase, const size_t nThreads,
+                std::vector<cofi::CofiEvaluator*>& evaluators) :
+        evaluators(evaluators) {
+            for (size_t i = 0; i < nThreads; ++i) {
+                iterators.push_back(new cofi::UserIterator(p, phase));
+            }
+            predictions.resize(nThreads);
+        }
+
+
+        ~EvaluationTask(void) {
+            for (size_t i = 0; i < iterators.size(); ++i) {
+                delete iterators[i];
+            }
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            cofi::UserIterator& iter = *(iterators[thread]);
+            cofi::YType& F = predictions[thread];
+            for (size_t user = begin; user < end; ++user) {
+                iter.advanceTo(user);
+                const cofi::YType& Y = iter.getY();
+                iter.predict(F);
+                for (size_t i = 0; i < evaluators.size(); ++i) {
+                    evaluators[i]->evalUser(user, Y, F);
+                }
+            }
+        }
+
+    private:
+        std::vector<cofi::CofiEvaluator*>& evaluators;
+        std::vector<cofi::UserIterator*> iterators;
+        std::vector<cofi::YType> predictions;
+    };
+
+
+    /**
+     * Evaluates all users of the given phase with all the evaluators, the
+     * results of evaluator i go to results[i].
+     */
+    void evalUsers(cofi::Problem& p, const cofi::UserIterator::Phase phase, std::vector<cofi::CofiEvaluator*>& evaluators,
+            const size_t nThreads, std::vector<map<string, double> >& results) {
+        const size_t nUsers = (phase == cofi::UserIterator::TRAINING) ? p.getTrainD().size1() : p.getTestD().size1();
+        for (size_t i = 0; i < evaluators.size(); ++i) {
+            evaluators[i]->begin(phase, nUsers);
+        }
+        EvaluationTask task(p, phase, nThreads, evaluators);
+        cofi::parallel::forEach(task, nUsers, nThreads, 16);
+        results.resize(evaluators.size());
+        for (size_t i = 0; i < evaluators.size(); ++i) {
+            evaluators[i]->finish(results[i]);
+        }
+    }
+}
+
+/**
+ * A state handed to the background thread: the values of the data
+ * independent evaluators and a snapshot to run the others on.
+ */
+struct cofi::CSVFileEvaluator::Snapshot {
+    std::vector<map<string, double> > dataLessValues;
+    cofi::Problem* problem;
+    double evaluationTime; // Spent so far, in the data independent evaluators
+};
+
+
+cofi::CSVFileEvaluator::CSVFileEvaluator(std::ostream& out):headerWritten(false), out(out), threadStarted(false), stopping(false), failed(false){
+    Configuration& conf = Configuration::getInstance();
+    nThreads = cofi::parallel::getNumberOfThreads();
+    const int async = conf.getInt("cofi.eval.async");
+    maxOutstanding = async > 0 ? static_cast<size_t> (async) : 0;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&changed, NULL);
+}// Constructor
 
 
 void cofi::CSVFileEvaluator::registerConfiguredEvaluators(void){
@@ -85,7 +177,7 @@ void cofi::CSVFileEvaluator::writeHeaders(void){
         }
         
     }
-    out << std::endl;
+    out << "evaluationTime" << std::endl;
     headerWritten = true;
 }
 
@@ -95,39 +187,164 @@ void cofi::CSVFileEvaluator::eval(cofi::Problem& p) {
         writeHeaders();
     }
     assert(headerWritten);
+    const double start = WallClock();
+    std::vector<map<string, double> > dataLessValues(dataLessEvals.size());
+    for (size_t i=0; i< dataLessEvals.size(); ++i) {
+        dataLessEvals[i]->eval(p, dataLessValues[i]);
+    }
+    
+    if (maxOutstanding == 0){
+        std::vector<map<string, double> > testValues;
+        std::vector<map<string, double> > trainValues;
+        evalData(p, testValues, trainValues);
+        writeRow(dataLessValues, testValues, trainValues, WallClock() - start);
+        return;
+    }
+    
+    Snapshot* snapshot = new Snapshot();
+    snapshot->dataLessValues.swap(dataLessValues);
+    snapshot->problem = p.snapshot();
+    snapshot->evaluationTime = WallClock() - start;
+    
+    pthread_mutex_lock(&lock);
+    if (!threadStarted) {
+        if (pthread_create(&thread, NULL, evaluateInBackground, this) != 0) {
+            pthread_mutex_unlock(&lock);
+            delete snapshot->problem;
+            delete snapshot;
+            throw CoFiException("CSVFileEvaluator::eval(): Could not start the evaluation thread");
+        }
+        threadStarted = true;
+    }
+    while (!failed && queue.size() >= maxOutstanding) {
+        pthread_cond_wait(&changed, &lock);
+    }
+    if (!failed) {
+        queue.push_back(snapshot);
+        snapshot = NULL;
+        pthread_cond_broadcast(&changed);
+    }
+    pthread_mutex_unlock(&lock);
+    
+    if (snapshot) {
+        delete snapshot->problem;
+        delete snapshot;
+        flush();
+    }
+}
+
+
+void cofi::CSVFileEvaluator::flush(void) {
+    pthread_mutex_lock(&lock);
+    while (!queue.empty()) {
+        pthread_cond_wait(&changed, &lock);
+    }
+    const bool hasFailed = failed;
+    const std::string message = error;
+    pthread_mutex_unlock(&lock);
+    if (hasFailed) {
+        throw CoFiException("CSVFileEvaluator: the background evaluation failed: " + message);
+    }
+}
+
+
+void cofi::CSVFileEvaluator::evalData(cofi::Problem& p, std::vector<map<string, double> >& testValues,
+        std::vector<map<string, double> >& trainValues) {
+    // One pass over the users per data set feeds all the evaluators
+    if (evaluateOnTestSet){
+        evalUsers(p, cofi::UserIterator::TESTING, dataEvals, nThreads, testValues);
+    }
+    if (evaluateOnTrainSet){
+        evalUsers(p, cofi::UserIterator::TRAINING, dataEvals, nThreads, trainValues);
+    }
+}
+
+
+void cofi::CSVFileEvaluator::writeRow(std::vector<map<string, double> >& dataLessValues,
+        std::vector<map<string, double> >& testValues, std::vector<map<string, double> >& trainValues,
+        const double evaluationTime) {
     for (size_t i=0; i< dataLessEvals.size(); ++i) {
         std::vector<string> names = dataLessEvals[i]->names();
-        map<string, double> values;
-        dataLessEvals[i]->eval(p, values);
         for (size_t j=0; j < names.size(); ++j) {
-            out << values[names[j]]<< s;
+            out << dataLessValues[i][names[j]]<< s;
         }
     }
     
     for (size_t i=0; i< dataEvals.size(); ++i) {
         
         std::vector<string> names = dataEvals[i]->names();
-        map<string, double> values;
         if (evaluateOnTestSet){
-            cofi::UserIterator iter = p.getTestIterator();
-            dataEvals[i]->eval(iter, values);
             for (size_t j=0; j < names.size(); ++j) {
-                out << values[names[j]]<< s;
+                out << testValues[i][names[j]]<< s;
             }
         }
         
         if (evaluateOnTrainSet){
-            cofi::UserIterator iter = p.getTrainIterator();
-            dataEvals[i]->eval(iter, values);
             for (size_t j=0; j < names.size(); ++j) {
-                out << values[names[j]]<< s;
+                out << trainValues[i][names[j]]<< s;
+            }
+        }
+    }
+    out << evaluationTime << std::endl;
+}
+
+
+void* cofi::CSVFileEvaluator::evaluateInBackground(void* self) {
+    CSVFileEvaluator& e = *static_cast<CSVFileEvaluator*> (self);
+    pthread_mutex_lock(&e.lock);
+    while (true) {
+        while (e.queue.empty() && !e.stopping) {
+            pthread_cond_wait(&e.changed, &e.lock);
+        }
+        if (e.queue.empty()) break;
+        // The snapshot stays in the queue until its row is written
+        Snapshot* snapshot = e.queue.front();
+        const bool skip = e.failed;
+        pthread_mutex_unlock(&e.lock);
+        
+        std::string message;
+        if (!skip) {
+            try {
+                const double start = WallClock();
+                std::vector<map<string, double> > testValues;
+                std::vector<map<string, double> > trainValues;
+                e.evalData(*snapshot->problem, testValues, trainValues);
+                e.writeRow(snapshot->dataLessValues, testValues, trainValues,
+                        snapshot->evaluationTime + WallClock() - start);
+            } catch (CoFiException& ex) {
+                message = ex.describe();
+            } catch (std::exception& ex) {
+                message = ex.what();
             }
         }
+        delete snapshot->problem;
+        delete snapshot;
+        
+        pthread_mutex_lock(&e.lock);
+        if (!message.empty() && !e.failed) {
+            e.failed = true;
+            e.error = message;
+        }
+        e.queue.pop_front();
+        pthread_cond_broadcast(&e.changed);
     }
-    out << std::endl;
+    pthread_mutex_unlock(&e.lock);
+    return NULL;
 }
 
+
 cofi::CSVFileEvaluator::~CSVFileEvaluator() {
+    // Finish the outstanding evaluations
+    if (threadStarted) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+        pthread_join(thread, NULL);
+    }
+    pthread_cond_destroy(&changed);
+    pthread_mutex_destroy(&lock);
+    
     // delete the evaluators
     for (size_t i=0; i< dataEvals.size(); ++i) {
         delete dataEvals[i];
@@ -19,6 +19,8 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <deque>
+#include <pthread.h>
 
 #include "cofi/eval/cofievaluator.hpp"
 #include "cofi/eval/dataindependentevaluator.hpp"
@@ -34,6 +36,11 @@ namespace cofi{
      * test data and those who don't. The latter are derived from
      * DataIndependentEvaluator, the former from CofiEvaluator.
      *
+     * If cofi.eval.async is n > 0, the data dependent evaluators run in a
+     * background thread on a snapshot of U, M and A, while the caller
+     * continues. The data independent ones are still evaluated when eval()
+     * is called. The rows are written in the order of the calls to eval(),
+     * which blocks while n snapshots are outstanding.
      *
      */
     class CSVFileEvaluator {
@@ -48,7 +55,8 @@ namespace cofi{
         CSVFileEvaluator(std::ostream& out);
         
         /**
-         * Destructor. Mainly deletes the evaluators.
+         * Destructor. Mainly deletes the evaluators, after finishing the
+         * outstanding evaluations.
          * DOES NOT CLOSE THE STREAM
          */
         ~CSVFileEvaluator();
@@ -71,14 +79,43 @@ namespace cofi{
         
         /**
          * Applys the evaluators to the current state and writes the results
-         * to the stream.
+         * to the stream. The last column is the time in seconds spent in
+         * this evaluation.
          *
          * @param p the Problem to evaluate.
          */
         void eval(cofi::Problem& p);
         
+        /**
+         * Waits for the outstanding evaluations. Needs to be called before
+         * the data of the Problem passed to eval() changes.
+         *
+         * @throws CoFiException if an evaluation in the background failed.
+         */
+        void flush(void);
+        
         
     private:
+        struct Snapshot;
+        
+        /**
+         * Runs the data dependent evaluators on p.
+         */
+        void evalData(cofi::Problem& p, std::vector<std::map<std::string, double> >& testValues,
+                std::vector<std::map<std::string, double> >& trainValues);
+        
+        /**
+         * Writes one row of results to the outstream.
+         */
+        void writeRow(std::vector<std::map<std::string, double> >& dataLessValues,
+                std::vector<std::map<std::string, double> >& testValues,
+                std::vector<std::map<std::string, double> >& trainValues, const double evaluationTime);
+        
+        /**
+         * The loop of the background thread, evaluates the queued snapshots.
+         */
+        static void* evaluateInBackground(void* self);
+        
         
         /**
          * The evaluators
@@ -103,6 +140,22 @@ namespace cofi{
         
         bool evaluateOnTestSet;
         bool evaluateOnTrainSet;
+        
+        size_t nThreads;                // Threads per evaluation
+        
+        /**
+         * The background evaluation. queue, stopping, failed and error are
+         * guarded by lock.
+         */
+        size_t maxOutstanding;          // 0 evaluates synchronously
+        std::deque<Snapshot*> queue;    // The snapshot being evaluated is in front
+        pthread_t thread;
+        bool threadStarted;
+        bool stopping;
+        bool failed;
+        std::string error;
+        pthread_mutex_t lock;
+        pthread_cond_t changed;         // Signalled whenever queue changes
     };
 }
 #endif
@@ -9,25 +9,29 @@ std::vector<std::string> cofi::MSEEvaluator::names(void){
     return result;
 }
 
-void cofi::MSEEvaluator::eval(cofi::UserIterator& iter, std::map<std::string, double>& results){
+void cofi::MSEEvaluator::begin(const cofi::UserIterator::Phase phase, const size_t nUsers){
+    errors.assign(nUsers, 0.0);
+    counts.assign(nUsers, 0);
+}
+
+void cofi::MSEEvaluator::evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& F){
+    assert(F.size1() == Y.size1());
+    assert(F.size2() == Y.size2());
+    Real error = 0.0;
+    for(size_t i=0; i<Y.size1(); ++i){
+        Real prediction = F(i, 0);
+        error += pow(Y(i, 0) - prediction, 2);
+    }
+    errors[user] = error;
+    counts[user] = Y.size1();
+}
+
+void cofi::MSEEvaluator::finish(std::map<std::string, double>& results){
     Real error = 0.0;
     size_t counter = 0;
-    while (iter.hasNext()) {
-        iter.advance();
-        ublas::matrix<Real>& Y = iter.getY();
-        ublas::matrix<Real>  F = ublas::matrix<Real>(Y.size1(), Y.size2());
-        iter.predict(F);
-        
-        assert(F.size1() == Y.size1());
-        assert(F.size2() == Y.size2());
-        
-        
-        for(size_t i=0; i<Y.size1(); ++i){
-            Real prediction = F(i, 0);
-            error   += pow(Y(i, 0) - prediction, 2);
-            counter += 1;
-        }
-        
+    for(size_t user=0; user<errors.size(); ++user){
+        error   += errors[user];
+        counter += counts[user];
     }
     error = error / ((Real) counter);
     results[MSE] = std::sqrt(error);
@@ -40,7 +40,13 @@ namespace cofi{
          */
         std::vector<std::string> names(void);
 
-        void eval(cofi::UserIterator& iter, std::map<std::string, double>& results);
+        void begin(const cofi::UserIterator::Phase phase, const size_t nUsers);
+        void evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& F);
+        void finish(std::map<std::string, double>& results);
+
+    private:
+        std::vector<Real> errors;    // The squared error per user
+        std::vector<size_t> counts;  // The number of ratings per user
     };
     
 }
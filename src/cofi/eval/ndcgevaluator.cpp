@@ -4,9 +4,10 @@
 #include "utils/ublastools.hpp"
 #include "loss/ndcgdomainmodel.hpp"
 #include "utils/utils.hpp"
+#include <algorithm>
 
 
-cofi::NDCGEvaluator::NDCGEvaluator(void):bigKWarned(false){
+cofi::NDCGEvaluator::NDCGEvaluator(void):bigKWarned(false), idealDCG(NULL){
     truncation = Configuration::getInstance().getInt("cofi.eval.ndcg.k");
     name = "NDCG@"+to_string(truncation);
 }
@@ -17,35 +18,52 @@ std::vector<std::string> cofi::NDCGEvaluator::names() {
     return result;
 }
 
-void cofi::NDCGEvaluator::eval(cofi::UserIterator& iter, std::map<std::string, double>& results) {
+void cofi::NDCGEvaluator::begin(const cofi::UserIterator::Phase phase, const size_t nUsers) {
+    idealDCG = &idealDCGs[phase];
+    if (idealDCG->size() != nUsers) {
+        idealDCG->assign(nUsers, 0.0);
+    }
+    ndcg.assign(nUsers, 0.0);
+    bigK.assign(nUsers, 0);
+}
+
+void cofi::NDCGEvaluator::evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& f) {
+    size_t k = truncation;
+    if (truncation > Y.size1()){
+        bigK[user] = 1;
+        k = Y.size1();
+    }
+    Real& perfectDCG = (*idealDCG)[user];
+    if (perfectDCG == 0.0) {
+        perfectDCG = NDCGDomainModel::dcg(Y, topK(Y, k), k);
+    }
     
-    double NDCG_SUM = 0.0;
-    size_t nUser = 0;
+    assert(f.size1() == Y.size1() && f.size2() == Y.size2());
+    const Real predictedDCG = NDCGDomainModel::dcg(Y, topK(f, k), k);
     
-    while (iter.hasNext()) {
-        ++nUser;
-        iter.advance();
-        const ublas::matrix<Real>& Y = iter.getY();
-        size_t k = truncation;
-        if (truncation > Y.size1()){
-            if(!bigKWarned){
-                std::clog << "NDCGEvaluator: k is bigger than Y.size1(). Using Y.size1() as k."<<std::endl;
-                bigKWarned = true;
-            }
-            k = Y.size1();
+    ndcg[user] = predictedDCG/perfectDCG;
+}
+
+ublas::vector<size_t> cofi::NDCGEvaluator::topK(const cofi::YType& f, const size_t k) {
+    ublas::vector<size_t> result(f.size1());
+    for (size_t i = 0; i < result.size(); ++i) {
+        result[i] = i;
+    }
+    DecreasingScore comp(f);
+    std::partial_sort(result.begin(), result.begin() + k, result.end(), comp);
+    return result;
+}
+
+void cofi::NDCGEvaluator::finish(std::map<std::string, double>& results) {
+    double NDCG_SUM = 0.0;
+    for (size_t user = 0; user < ndcg.size(); ++user) {
+        if (bigK[user] && !bigKWarned) {
+            std::clog << "NDCGEvaluator: k is bigger than Y.size1(). Using Y.size1() as k."<<std::endl;
+            bigKWarned = true;
         }
-        const ublas::vector<size_t> sp = cofi::ublastools::decreasingSort<ublas::matrix<double> >(Y);
-        const Real perfectDCG = NDCGDomainModel::dcg(Y, sp, k);
-        
-        ublas::matrix<Real> f(Y.size1(), Y.size2());
-        iter.predict(f);
-        assert(f.size1() == Y.size1() && f.size2() == Y.size2());
-        const ublas::vector<size_t> pp = cofi::ublastools::decreasingSort<ublas::matrix<double> >(f);
-        const Real predictedDCG = NDCGDomainModel::dcg(Y, pp, k);
-        
-        NDCG_SUM += predictedDCG/perfectDCG;
+        NDCG_SUM += ndcg[user];
     }
-    const double avg_ndcg = NDCG_SUM / static_cast<double>(nUser);
+    const double avg_ndcg = NDCG_SUM / static_cast<double>(ndcg.size());
     
     results[name] = avg_ndcg;
 }
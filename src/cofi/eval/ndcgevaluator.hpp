@@ -26,6 +26,11 @@ namespace cofi{
     /**
      * A evaluator which determines the average NDCG for all the rows in U
      *
+     * Only the top k positions of the predicted ranking are sorted. The
+     * ideal DCG of each user is computed once per data set and cached, as
+     * the ratings do not change. Ties in the prediction are ranked by the
+     * order of the items in Y.
+     *
      * @author Markus Weimer
      */
     class NDCGEvaluator : public CofiEvaluator {
@@ -38,12 +43,38 @@ namespace cofi{
          */
         std::vector<std::string> names(void);
         
-        void eval(cofi::UserIterator& iter, std::map<std::string, double>& results);
+        void begin(const cofi::UserIterator::Phase phase, const size_t nUsers);
+        void evalUser(const size_t user, const cofi::YType& Y, const cofi::YType& F);
+        void finish(std::map<std::string, double>& results);
         
     private:
+        /**
+         * Orders the indices of f decreasingly by their value, and the ties
+         * increasingly by index.
+         */
+        class DecreasingScore {
+        public:
+            DecreasingScore(const cofi::YType& f) : f(f) {}
+            inline bool operator()(const size_t a, const size_t b) const {
+                return f(a, 0) > f(b, 0) || (f(a, 0) == f(b, 0) && a < b);
+            }
+        private:
+            const cofi::YType& f;
+        };
+
+        /**
+         * @return the indices of f with the k largest entries in front,
+         *         ordered by DecreasingScore, the others in any order.
+         */
+        static ublas::vector<size_t> topK(const cofi::YType& f, const size_t k);
+
         size_t truncation;
         std::string name;
         bool bigKWarned; // True if we warned the user that k is bigger than Y for some users.
+        std::vector<Real> ndcg;   // The NDCG per user
+        std::vector<char> bigK;   // Whether k is bigger than Y, per user
+        std::map<cofi::UserIterator::Phase, std::vector<Real> > idealDCGs; // The ideal DCG per user, 0 until computed
+        std::vector<Real>* idealDCG; // The ideal DCGs of the current data set
     };
     
 }
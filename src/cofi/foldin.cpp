@@ -0,0 +1,253 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "foldin.hpp"
+
+#include <cmath>
+
+#include "core/cofiexception.hpp"
+#include "cofi/problem.hpp"
+#include "loss/leastsquaredomainmodel.hpp"
+#include "loss/userloss.hpp"
+#include "loss/adaptiveregularizationlosswrapper.hpp"
+#include "utils/configuration.hpp"
+
+namespace {
+
+    // The first entry of the settings matrix. Increment whenever the
+    // layout changes.
+    const Real SETTINGS_VERSION = 3;
+
+    const size_t SETTINGS_SIZE = 29;
+
+    // Version 1 lacks the options of the inner solver, which had their
+    // defaults then, version 2 the choice of the solver, which was BMRM.
+    const size_t SETTINGS_SIZE_1 = 14;
+    const size_t SETTINGS_SIZE_2 = 21;
+}
+
+
+cofi::FoldInSettings cofi::FoldInSettings::fromConfiguration(Problem& p) {
+    if (p.usingGraphKernel()) {
+        throw CoFiException("FoldInSettings: Users cannot be folded in when using the graph kernel");
+    }
+    Configuration& conf = Configuration::getInstance();
+    const LossFunctionFactory& factory = LossFunctionFactory::getInstance();
+    FoldInSettings s;
+    s.loss = factory.getModel();
+    s.ndcgTrainK = factory.getNDCGTrainK();
+    s.ndcgCExponent = factory.getNDCGCExponent();
+    s.lambda = conf.getDouble("cofi.userphase.lambda");
+    s.useMovieOffset = p.usingMovieOffset();
+    s.useAdaptiveRegularization = p.usingAdaptiveRegularization();
+    s.adaptiveRegularizationExponent = conf.getDouble("cofi.adaptiveRegularization.uExponent");
+    s.maxRatingsPerUser = p.getMaxRatingsPerUser();
+    // As read by Solver
+    s.gammaTol = conf.getDouble("bmrm.minProgress");
+    s.epsilonTol = conf.getDouble("bmrm.minOptimProgress");
+    s.maxIter = conf.getInt("bmrm.maxNumberOfIterations");
+    s.relGammaTol = conf.getDouble("bmrm.minRelativeProgress");
+    s.relEpsilonTol = conf.getDouble("bmrm.minRelativeOptimProgress");
+    s.innerSolver = Solver::readInnerSolverSettings();
+    s.solver = Solver::readSolver();
+    s.lbfgsMemory = conf.getInt("lbfgs.memory");
+    s.lbfgsMinRelativeProgress = conf.getDouble("lbfgs.minRelativeProgress");
+    s.lbfgsMaxIter = conf.getInt("lbfgs.maxNumberOfIterations");
+    s.subgradientStepSize = conf.getDouble("subgradient.initialStepSize");
+    s.subgradientMinRelativeProgress = conf.getDouble("subgradient.minRelativeProgress");
+    s.subgradientMaxIter = conf.getInt("subgradient.maxNumberOfIterations");
+    s.direct = conf.getInt("cofi.userphase.direct") == 1;
+    return s;
+}
+
+
+ublas::matrix<Real> cofi::FoldInSettings::toMatrix(void) const {
+    ublas::matrix<Real> m(1, SETTINGS_SIZE);
+    m(0, 0) = SETTINGS_VERSION;
+    m(0, 1) = loss;
+    m(0, 2) = ndcgTrainK;
+    m(0, 3) = ndcgCExponent;
+    m(0, 4) = lambda;
+    m(0, 5) = useMovieOffset ? 1 : 0;
+    m(0, 6) = useAdaptiveRegularization ? 1 : 0;
+    m(0, 7) = adaptiveRegularizationExponent;
+    m(0, 8) = maxRatingsPerUser;
+    m(0, 9) = gammaTol;
+    m(0, 10) = epsilonTol;
+    m(0, 11) = relGammaTol;
+    m(0, 12) = relEpsilonTol;
+    m(0, 13) = maxIter;
+    m(0, 14) = innerSolver.maxGradSetSize;
+    m(0, 15) = innerSolver.gradIdleAge;
+    m(0, 16) = innerSolver.removeAllIdleGradients ? 1 : 0;
+    m(0, 17) = innerSolver.maxBundleBytes;
+    m(0, 18) = innerSolver.singlePrecision ? 1 : 0;
+    m(0, 19) = innerSolver.maxProjIter;
+    m(0, 20) = innerSolver.maxPGMIter;
+    m(0, 21) = solver;
+    m(0, 22) = lbfgsMemory;
+    m(0, 23) = lbfgsMinRelativeProgress;
+    m(0, 24) = lbfgsMaxIter;
+    m(0, 25) = subgradientStepSize;
+    m(0, 26) = subgradientMinRelativeProgress;
+    m(0, 27) = subgradientMaxIter;
+    m(0, 28) = direct ? 1 : 0;
+    return m;
+}
+
+
+cofi::FoldInSettings cofi::FoldInSettings::fromMatrix(const ublas::matrix<Real>& m) {
+    const bool version1 = m.size1() == 1 && m.size2() == SETTINGS_SIZE_1 && m(0, 0) == 1;
+    const bool version2 = m.size1() == 1 && m.size2() == SETTINGS_SIZE_2 && m(0, 0) == 2;
+    if (!version1 && !version2 && (m.size1() != 1 || m.size2() != SETTINGS_SIZE || m(0, 0) != SETTINGS_VERSION)) {
+        throw CoFiException("FoldInSettings: Not a settings matrix of this version");
+    }
+    FoldInSettings s;
+    s.loss = static_cast<LossFunctionFactory::ModelEnum> (static_cast<int> (m(0, 1)));
+    s.ndcgTrainK = static_cast<size_t> (m(0, 2));
+    s.ndcgCExponent = m(0, 3);
+    s.lambda = m(0, 4);
+    s.useMovieOffset = m(0, 5) != 0;
+    s.useAdaptiveRegularization = m(0, 6) != 0;
+    s.adaptiveRegularizationExponent = m(0, 7);
+    s.maxRatingsPerUser = m(0, 8);
+    s.gammaTol = m(0, 9);
+    s.epsilonTol = m(0, 10);
+    s.relGammaTol = m(0, 11);
+    s.relEpsilonTol = m(0, 12);
+    s.maxIter = static_cast<int> (m(0, 13));
+    if (!version1) {
+        s.innerSolver.maxGradSetSize = static_cast<int> (m(0, 14));
+        s.innerSolver.gradIdleAge = static_cast<int> (m(0, 15));
+        s.innerSolver.removeAllIdleGradients = m(0, 16) != 0;
+        s.innerSolver.maxBundleBytes = m(0, 17);
+        s.innerSolver.singlePrecision = m(0, 18) != 0;
+        s.innerSolver.maxProjIter = static_cast<int> (m(0, 19));
+        s.innerSolver.maxPGMIter = static_cast<int> (m(0, 20));
+    }
+    s.solver = Solver::bmrm;
+    s.lbfgsMemory = 0;
+    s.lbfgsMinRelativeProgress = 0;
+    s.lbfgsMaxIter = 0;
+    s.subgradientStepSize = 0;
+    s.subgradientMinRelativeProgress = 0;
+    s.subgradientMaxIter = 0;
+    s.direct = false;
+    if (!version1 && !version2) {
+        s.solver = static_cast<Solver::Solvers> (static_cast<int> (m(0, 21)));
+        s.lbfgsMemory = static_cast<size_t> (m(0, 22));
+        s.lbfgsMinRelativeProgress = m(0, 23);
+        s.lbfgsMaxIter = static_cast<int> (m(0, 24));
+        s.subgradientStepSize = m(0, 25);
+        s.subgradientMinRelativeProgress = m(0, 26);
+        s.subgradientMaxIter = static_cast<int> (m(0, 27));
+        s.direct = m(0, 28) != 0;
+    }
+    return s;
+}
+
+
+cofi::FoldIn::FoldIn(const cofi::MType& M, const FoldInSettings& settings) :
+M(M), settings(settings),
+solver(settings.gammaTol, settings.epsilonTol, settings.relGammaTol, settings.relEpsilonTol, settings.maxIter, settings.innerSolver),
+loss(NULL), weightedLoss(NULL), userRow(1, M.size2()), rated(1, M.size1()), recommender(userRow, M) {
+    if (settings.direct && settings.loss != LossFunctionFactory::REGRESSION) {
+        throw CoFiException("FoldIn: The direct solve requires the loss REGRESSION");
+    }
+    if (settings.solver == Solver::lbfgs) {
+        solver.useLBFGS(settings.lbfgsMemory, settings.lbfgsMinRelativeProgress, settings.lbfgsMaxIter);
+    } else if (settings.solver == Solver::subgradient) {
+        solver.useSubgradient(settings.subgradientStepSize, settings.subgradientMinRelativeProgress, settings.subgradientMaxIter);
+    }
+    X.setSource(M);
+    recommender.setExcluded(&rated);
+}
+
+
+cofi::FoldIn::~FoldIn(void) {
+    delete weightedLoss;
+    delete loss;
+}
+
+
+Real cofi::FoldIn::solve(const std::vector<itemid>& items, const std::vector<Real>& ratings, cofi::WType& u) {
+    if (items.size() != ratings.size()) {
+        throw CoFiException("FoldIn::solve: items and ratings differ in their size");
+    }
+    u.resize(M.size2(), 1, false);
+    u.clear();
+    if (settings.useMovieOffset) {
+        u(cofi::MOVIE_OFFSET_COLUMN, 0) = 1;
+    }
+    const size_t rows = items.size();
+    if (rows == 0) {
+        return 0.0;
+    }
+
+    // Setup X and Y as UserIterator does for the users of the training data
+    X.resize(rows);
+    Y.resize(rows, 1, false);
+    for (size_t row = 0; row < rows; ++row) {
+        if (items[row] >= M.size1()) {
+            throw CoFiException("FoldIn::solve: an item is not in M");
+        }
+        X.setIndex(row, items[row]);
+        Y(row, 0) = ratings[row];
+    }
+
+    if (loss == NULL) {
+        loss = LossFunctionFactory::create(settings.loss, X, Y, settings.ndcgTrainK, settings.ndcgCExponent);
+    } else {
+        loss->reset();
+    }
+    const Real weight = settings.useAdaptiveRegularization ?
+            pow(rows / settings.maxRatingsPerUser, settings.adaptiveRegularizationExponent) : 1.0;
+    if (settings.direct) {
+        // As the direct mode of the user phase
+        const size_t offsetColumn = settings.useMovieOffset ? cofi::MOVIE_OFFSET_COLUMN : M.size2();
+        return static_cast<LeastSquareDomainModel*> (loss)->solve(u, settings.lambda, weight, offsetColumn);
+    }
+    CofiLossFunction* realLoss = loss;
+    if (settings.useAdaptiveRegularization) {
+        if (weightedLoss == NULL) {
+            weightedLoss = new AdaptiveRegularizationLossWrapper(weight, *loss);
+        } else {
+            weightedLoss->setWeight(weight);
+        }
+        realLoss = weightedLoss;
+    }
+    cofi::UserLoss userLoss(*realLoss, settings.useMovieOffset);
+    return solver.optimize(u, userLoss, settings.lambda, 1);
+}
+
+
+void cofi::FoldIn::recommend(const cofi::WType& u, const std::vector<itemid>& items, const size_t k,
+        std::vector<Recommendation>& result, const ItemIndex* index, const size_t nProbe) {
+    row(userRow, 0) = column(u, 0);
+    ratedItems.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i] < M.size1()) {
+            ratedItems.push_back(items[i]);
+        }
+    }
+    ratedValues.assign(ratedItems.size(), 1.0);
+    const size_t ratedStart[2] = {0, ratedItems.size()};
+    rated.assign(1, M.size1(), ratedStart, ratedItems.empty() ? NULL : &ratedItems[0],
+            ratedValues.empty() ? NULL : &ratedValues[0]);
+    recommender.setIndex(index, nProbe);
+    recommender.recommend(0, 1, k, recommendations, 1);
+    result = recommendations[0];
+}
@@ -0,0 +1,151 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _FOLDIN_HPP_
+#define _FOLDIN_HPP_
+
+#include <string>
+#include <vector>
+
+#include "core/types.hpp"
+#include "cofi/recommender.hpp"
+#include "cofi/solver.hpp"
+#include "loss/lossfunctionfactory.hpp"
+
+namespace cofi {
+
+    class AdaptiveRegularizationLossWrapper;
+    class ItemIndex;
+    class Problem;
+
+    /**
+     * The settings of the per user problems of a trained model.
+     *
+     * They are stored with the model as the matrix "settings", such that new
+     * users can be folded in without the configuration of the training run.
+     */
+    struct FoldInSettings {
+        LossFunctionFactory::ModelEnum loss;
+        size_t ndcgTrainK;
+        double ndcgCExponent;
+        Real lambda;                            // cofi.userphase.lambda
+        bool useMovieOffset;
+        bool useAdaptiveRegularization;
+        double adaptiveRegularizationExponent;  // cofi.adaptiveRegularization.uExponent
+        Real maxRatingsPerUser;                 // The count the adaptive weights are relative to
+        double gammaTol;                        // The BMRM convergence criteria
+        double epsilonTol;
+        double relGammaTol;
+        double relEpsilonTol;
+        int maxIter;
+        DualInnerSolverSettings innerSolver;    // The bundle of BMRM
+        Solver::Solvers solver;                 // cofi.solver
+        size_t lbfgsMemory;                     // The options of LBFGS, lbfgs.*
+        double lbfgsMinRelativeProgress;
+        int lbfgsMaxIter;
+        double subgradientStepSize;             // The options of SUBGRADIENT, subgradient.*
+        double subgradientMinRelativeProgress;
+        int subgradientMaxIter;
+        bool direct;                            // cofi.userphase.direct
+
+
+        /**
+         * @return the settings the given problem is trained with.
+         * @throws CoFiException if the problem uses the graph kernel, whose
+         *         user problems involve all other users.
+         */
+        static FoldInSettings fromConfiguration(Problem& p);
+
+
+        /**
+         * @return the settings as a matrix to store in a model file.
+         */
+        ublas::matrix<Real> toMatrix(void) const;
+
+
+        /**
+         * @return the settings stored by toMatrix(). Settings stored before
+         *         the solver was part of them select BMRM.
+         * @throws CoFiException if the matrix does not hold settings.
+         */
+        static FoldInSettings fromMatrix(const ublas::matrix<Real>& m);
+    };
+
+
+    /**
+     * Solves the problem of a new user against a fixed M, as the user phase
+     * does for the users of the training data, with the same solver or the
+     * direct least squares solve, and recommends items to it.
+     *
+     * This needs neither a Problem nor the configuration. The workspaces are
+     * kept between calls, so an instance should serve many users, one at a
+     * time. Instances are not safe to share between threads.
+     */
+    class FoldIn {
+    public:
+        /**
+         * @param M the item features of the model. It has to stay alive and
+         *        unchanged while this object is used.
+         * @throws CoFiException if the settings select the direct solve for
+         *         a loss other than REGRESSION.
+         */
+        FoldIn(const cofi::MType& M, const FoldInSettings& settings);
+
+        ~FoldIn(void);
+
+
+        /**
+         * Computes the features of a user with the given ratings.
+         *
+         * @param items the rated items, counted from 0, strictly increasing.
+         * @param ratings the rating of each item.
+         * @param u the features of the user, of size M.size2() x 1.
+         * @return the loss of the user's problem at the solution.
+         * @throws CoFiException if an item is not in M.
+         */
+        Real solve(const std::vector<itemid>& items, const std::vector<Real>& ratings, cofi::WType& u);
+
+
+        /**
+         * Recommends the k best items not in items to the user with the
+         * features u, through the index if one is given.
+         */
+        void recommend(const cofi::WType& u, const std::vector<itemid>& items, const size_t k,
+                std::vector<Recommendation>& result, const ItemIndex* index = NULL, const size_t nProbe = 0);
+
+    private:
+        // Not implemented, the loss functions are owned.
+        FoldIn(const FoldIn& other);
+        FoldIn& operator=(const FoldIn& other);
+
+        const cofi::MType& M;
+        const FoldInSettings settings;
+        cofi::Solver solver;
+        cofi::XType X;
+        cofi::YType Y;
+        CofiLossFunction* loss;
+        AdaptiveRegularizationLossWrapper* weightedLoss;
+
+        // The single user and its ratings the recommender works on
+        cofi::UType userRow;
+        cofi::DType rated;
+        std::vector<itemid> ratedItems;
+        std::vector<Real> ratedValues;
+        Recommender recommender;
+        std::vector<std::vector<Recommendation> > recommendations;
+    };
+}
+#endif /* _FOLDIN_HPP_ */
@@ -0,0 +1,238 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "itemindex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/parallel.hpp"
+
+namespace {
+
+    inline Real dot(const Real* a, const Real* b, const size_t n) {
+        Real result = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            result += a[i] * b[i];
+        }
+        return result;
+    }
+
+
+    /**
+     * Assigns every point to the centroid closest to it, which is the one
+     * maximizing point*centroid - |centroid|^2/2.
+     */
+    class AssignTask : public cofi::parallel::RangeTask {
+    public:
+
+        AssignTask(const std::vector<Real>& points, const std::vector<Real>& centroids,
+                const std::vector<Real>& halfNorms, const size_t dim, std::vector<size_t>& assignment) :
+        points(points), centroids(centroids), halfNorms(halfNorms), dim(dim), assignment(assignment) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            for (size_t j = begin; j < end; ++j) {
+                const Real* x = &points[j * dim];
+                size_t best = 0;
+                Real bestScore = dot(x, &centroids[0], dim) - halfNorms[0];
+                for (size_t l = 1; l < halfNorms.size(); ++l) {
+                    const Real score = dot(x, &centroids[l * dim], dim) - halfNorms[l];
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = l;
+                    }
+                }
+                assignment[j] = best;
+            }
+        }
+
+    private:
+        const std::vector<Real>& points;
+        const std::vector<Real>& centroids;
+        const std::vector<Real>& halfNorms;
+        const size_t dim;
+        std::vector<size_t>& assignment;
+    };
+
+
+    void computeHalfNorms(const std::vector<Real>& centroids, const size_t dim, std::vector<Real>& halfNorms) {
+        for (size_t l = 0; l < halfNorms.size(); ++l) {
+            halfNorms[l] = dot(&centroids[l * dim], &centroids[l * dim], dim) / 2.0;
+        }
+    }
+
+
+    /**
+     * Orders lists by decreasing score, ties by increasing list.
+     */
+    class ByScore {
+    public:
+
+        ByScore(const std::vector<Real>& scores) : scores(scores) {
+        }
+
+        bool operator()(const size_t a, const size_t b) const {
+            return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+        }
+
+    private:
+        const std::vector<Real>& scores;
+    };
+}
+
+
+cofi::ItemIndex::ItemIndex(const cofi::MType& M, const size_t nLists, const size_t nIterations, const size_t nThreads) : dim(M.size2()) {
+    const size_t n = M.size1();
+    const size_t lists = n == 0 ? 0 : std::max<size_t > (1, std::min(nLists, n));
+    const size_t augDim = dim + 1;
+
+    // The rows of M, extended to the same norm
+    std::vector<Real> points(n * augDim);
+    Real maxNorm2 = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+        Real norm2 = 0.0;
+        for (size_t d = 0; d < dim; ++d) {
+            points[j * augDim + d] = M(j, d);
+            norm2 += M(j, d) * M(j, d);
+        }
+        points[j * augDim + dim] = norm2;
+        maxNorm2 = std::max(maxNorm2, norm2);
+    }
+    for (size_t j = 0; j < n; ++j) {
+        points[j * augDim + dim] = std::sqrt(std::max(0.0, maxNorm2 - points[j * augDim + dim]));
+    }
+    radius = std::sqrt(maxNorm2);
+
+    // k-means on a sample of evenly spaced items, which is plenty to place
+    // the centroids, starting from every sampleSize/lists-th of them
+    const size_t sampleSize = std::min(n, TRAINING_POINTS_PER_LIST * lists);
+    std::vector<Real> sample(sampleSize * augDim);
+    for (size_t s = 0; s < sampleSize; ++s) {
+        const size_t j = s * n / sampleSize;
+        std::copy(&points[j * augDim], &points[j * augDim] + augDim, &sample[s * augDim]);
+    }
+    centroids.resize(lists * augDim);
+    halfNorms.resize(lists);
+    for (size_t l = 0; l < lists; ++l) {
+        const size_t s = l * sampleSize / lists;
+        std::copy(&sample[s * augDim], &sample[s * augDim] + augDim, &centroids[l * augDim]);
+    }
+    std::vector<size_t> assignment(sampleSize, 0);
+    std::vector<Real> sums(lists * augDim);
+    std::vector<size_t> counts(lists);
+    for (size_t iteration = 0; iteration < nIterations && lists > 0; ++iteration) {
+        computeHalfNorms(centroids, augDim, halfNorms);
+        AssignTask task(sample, centroids, halfNorms, augDim, assignment);
+        cofi::parallel::forEach(task, sampleSize, nThreads, 256);
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t s = 0; s < sampleSize; ++s) {
+            const size_t l = assignment[s];
+            for (size_t d = 0; d < augDim; ++d) {
+                sums[l * augDim + d] += sample[s * augDim + d];
+            }
+            ++counts[l];
+        }
+        for (size_t l = 0; l < lists; ++l) {
+            // Empty lists keep their centroid
+            if (counts[l] == 0) continue;
+            for (size_t d = 0; d < augDim; ++d) {
+                centroids[l * augDim + d] = sums[l * augDim + d] / counts[l];
+            }
+        }
+    }
+
+    // Assign all items to the final centroids
+    assignment.resize(n);
+    if (lists > 0) {
+        computeHalfNorms(centroids, augDim, halfNorms);
+        AssignTask task(points, centroids, halfNorms, augDim, assignment);
+        cofi::parallel::forEach(task, n, nThreads, 256);
+    }
+
+    // Lay out the items list by list, in increasing order within a list
+    listStart.assign(lists + 1, 0);
+    for (size_t j = 0; j < n; ++j) {
+        ++listStart[assignment[j] + 1];
+    }
+    for (size_t l = 0; l < lists; ++l) {
+        listStart[l + 1] += listStart[l];
+    }
+    items.resize(n);
+    vectors.resize(n * dim);
+    std::vector<size_t> next(listStart.begin(), listStart.end() - 1);
+    for (size_t j = 0; j < n; ++j) {
+        const size_t pos = next[assignment[j]]++;
+        items[pos] = j;
+        for (size_t d = 0; d < dim; ++d) {
+            vectors[pos * dim + d] = M(j, d);
+        }
+    }
+}
+
+
+void cofi::ItemIndex::search(const Real* u, const size_t k, const size_t nProbe, const std::vector<itemid>& excluded,
+        std::vector<Recommendation>& result, Workspace& ws) const {
+    result.clear();
+    const size_t lists = getNumberOfLists();
+    if (k == 0 || lists == 0) {
+        return;
+    }
+    result.reserve(k);
+
+    // The query is extended by 0, so the last coordinate of the centroids
+    // does not contribute. It is scaled to the norm of the extended items,
+    // which does not change the order of the items, but makes the closest
+    // centroid the one with the closest items.
+    const size_t augDim = dim + 1;
+    const Real norm = std::sqrt(dot(u, u, dim));
+    const Real scale = norm > 0.0 ? radius / norm : 0.0;
+    ws.listScores.resize(lists);
+    ws.lists.resize(lists);
+    for (size_t l = 0; l < lists; ++l) {
+        ws.listScores[l] = scale * dot(u, &centroids[l * augDim], dim) - halfNorms[l];
+        ws.lists[l] = l;
+    }
+    const size_t probes = std::max<size_t > (1, std::min(nProbe, lists));
+    std::partial_sort(ws.lists.begin(), ws.lists.begin() + probes, ws.lists.end(), ByScore(ws.listScores));
+
+    const BetterRecommendation better;
+    for (size_t p = 0; p < probes; ++p) {
+        const size_t l = ws.lists[p];
+        for (size_t pos = listStart[l]; pos < listStart[l + 1]; ++pos) {
+            Recommendation r;
+            r.item = items[pos];
+            r.score = dot(u, &vectors[pos * dim], dim);
+            const bool full = result.size() == k;
+            if (full && !better(r, result.front())) {
+                continue;
+            }
+            if (std::binary_search(excluded.begin(), excluded.end(), r.item)) {
+                continue;
+            }
+            if (full) {
+                std::pop_heap(result.begin(), result.end(), better);
+                result.back() = r;
+            } else {
+                result.push_back(r);
+            }
+            std::push_heap(result.begin(), result.end(), better);
+        }
+    }
+    std::sort_heap(result.begin(), result.end(), better);
+}
@@ -0,0 +1,98 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _ITEMINDEX_HPP_
+#define _ITEMINDEX_HPP_
+
+#include <vector>
+
+#include "core/types.hpp"
+#include "cofi/recommender.hpp"
+
+namespace cofi {
+
+    /**
+     * An approximate maximum inner product search index over the rows of M.
+     *
+     * The items are clustered into lists by k-means (an inverted file). To
+     * make the nearest centroid also the one of largest inner product, every
+     * row m of M is extended by the coordinate sqrt(maxNorm^2 - |m|^2), which
+     * gives all rows the same norm, while the queries are extended by 0 and
+     * scaled to that norm.
+     *
+     * A query scores the centroids, and then scores exactly the items of the
+     * nProbe best lists. Larger nProbe trades speed for recall; with
+     * nProbe = nLists, the search is exhaustive.
+     */
+    class ItemIndex {
+    public:
+        // k-means iterations, enough to settle on typical factors
+        static const size_t DEFAULT_ITERATIONS = 10;
+
+        // The k-means runs on at most this many items per list
+        static const size_t TRAINING_POINTS_PER_LIST = 64;
+
+
+        /**
+         * Per thread scratch space of search().
+         */
+        struct Workspace {
+            std::vector<Real> listScores;
+            std::vector<size_t> lists;
+        };
+
+
+        /**
+         * Builds the index.
+         *
+         * @param M the item features, one item per row.
+         * @param nLists the number of lists; at most the number of items.
+         * @param nIterations the number of k-means iterations.
+         * @param nThreads the number of threads to build with.
+         */
+        ItemIndex(const cofi::MType& M, const size_t nLists, const size_t nIterations, const size_t nThreads);
+
+
+        /**
+         * @return the number of lists of the index.
+         */
+        size_t getNumberOfLists(void) const {
+            return listStart.size() - 1;
+        }
+
+
+        /**
+         * Finds the (approximately) k best items for the given query.
+         *
+         * @param u the query, usually a row of U, with M.size2() entries.
+         * @param excluded sorted items not to return.
+         * @param result the at most k best items found, in decreasing order
+         *        of their score. Ties are broken by the smaller item index.
+         */
+        void search(const Real* u, const size_t k, const size_t nProbe, const std::vector<itemid>& excluded,
+                std::vector<Recommendation>& result, Workspace& ws) const;
+
+    private:
+        size_t dim;                     // Number of columns of M
+        Real radius;                    // Norm of the extended rows of M
+        std::vector<Real> centroids;    // nLists x (dim+1), row major
+        std::vector<Real> halfNorms;    // |centroid|^2 / 2
+        std::vector<size_t> listStart;  // The items of list l are at [listStart[l], listStart[l+1])
+        std::vector<itemid> items;      // The item ids, ordered by list
+        std::vector<Real> vectors;      // The rows of M, ordered by list
+    };
+}
+#endif /* _ITEMINDEX_HPP_ */
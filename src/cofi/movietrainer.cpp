@@ -20,6 +20,7 @@
  */
 
 #include <cassert>
+#include <iostream>
 #include "movietrainer.hpp"
 #include "solver.hpp"
 #include "loss/moviephaselossfunction.hpp"
@@ -44,7 +45,14 @@ Real cofi::MovieTrainer::run(cofi::Problem& p, size_t t, Real lambda){
     MoviePhaseLossFunction m(p);
     cofi::Solver solver;
 
-    const Real loss = solver.optimize(p.getM(), m, lambda, t);
+    const Real loss = solver.optimize(p.getM(), m, lambda, t, NULL, NULL, &warmStart);
+    statistics = solver.getStatistics();
+    const BundleStatistics& s = statistics;
+    std::clog << "MovieTrainer::run: The solver spent " << s.loss << "s in the loss, "
+            << s.update << "s updating the bundle, " << s.qp << "s in " << s.qpSolves << " QPs ("
+            << s.pgmIterations << " PGM iterations, " << s.projections << " projection steps), "
+            << s.solution << "s in the solution, the bundle took "
+            << s.peakBytes / (1024 * 1024) << "MB" << std::endl;
 
     if(p.usingUserOffset()){ // Set the column of the bias to 1 again
         p.setUserOffsetColumnInMToOne();
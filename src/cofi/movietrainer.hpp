@@ -24,11 +24,15 @@
 
 #include "core/types.hpp"
 #include "cofi/problem.hpp"
+#include "bmrm/bmrm.hpp"
 
 
 namespace cofi{
     /**
      * Subspace decent in M.
+     *
+     * With bmrm.warmStartPlanes, the BMRM state is kept from one run to the
+     * next.
      */
     class MovieTrainer{
         
@@ -40,7 +44,17 @@ namespace cofi{
          * @param p The Problem to work on
          */
         Real run(cofi::Problem& p, size_t t, Real lambda);
-        
+
+        /**
+         * @return the statistics of BMRM in the last run.
+         */
+        const BundleStatistics& getStatistics(void) const {
+            return statistics;
+        }
+
+    private:
+        BMRMWarmStart warmStart;
+        BundleStatistics statistics;
     };
 }
 
@@ -23,24 +23,49 @@
 #include "utils/ublastools.hpp"
 #include "cofi/useriterator.hpp"
 #include "io/io.hpp"
+#include "io/svmlightloader.hpp"
+#include "io/csrcache.hpp"
+#include "io/modelio.hpp"
+#include "cofi/recommender.hpp"
+#include "cofi/itemindex.hpp"
+#include "cofi/foldin.hpp"
+#include "utils/parallel.hpp"
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/matrix_sparse.hpp>
 
 
 cofi::Problem::~Problem(void) {
-    if (trainD) delete trainD;
-    if (testD) delete testD;
+    if (ownsData) {
+        if (trainD) delete trainD;
+        if (testD) delete testD;
+        if (S) delete S;
+        delete trainStrong;
+        delete testStrong;
+    }
     if (U) delete U;
     if (M) delete M;
     if (A) delete A;
-    if (S) delete S;
     if (bestM) delete bestM;
 }
 
 
+cofi::Problem::Problem(const Problem& other) :
+ownsData(false), useMovieOffset(other.useMovieOffset), useUserOffset(other.useUserOffset),
+useGraphKernel(other.useGraphKernel), useAdaptiveRegularization(other.useAdaptiveRegularization),
+evalMode(other.evalMode), dimW(other.dimW), trainD(other.trainD), testD(other.testD), S(other.S),
+trainStrong(NULL), testStrong(NULL), U(new cofi::UType(*other.U)), M(new cofi::MType(*other.M)), A(other.A ? new cofi::MType(*other.A) : NULL),
+bestM(NULL), nMovies(other.nMovies), weightsU(other.weightsU), maxRatingsPerUser(other.maxRatingsPerUser) {
+}
+
+
+cofi::Problem* cofi::Problem::snapshot(void) {
+    return new Problem(*this);
+}
+
+
 cofi::Problem::Problem(void) :
-useMovieOffset(false), useUserOffset(false), evalMode(WEAK), trainD(NULL), testD(NULL),
-S(NULL), U(NULL), M(NULL), A(NULL), bestM(NULL) {
+ownsData(true), useMovieOffset(false), useUserOffset(false), evalMode(WEAK), trainD(NULL), testD(NULL),
+S(NULL), trainStrong(NULL), testStrong(NULL), U(NULL), M(NULL), A(NULL), bestM(NULL), maxRatingsPerUser(0) {
 
     // Configuration parsing
     Configuration& conf = Configuration::getInstance();
@@ -70,7 +95,11 @@ S(NULL), U(NULL), M(NULL), A(NULL), bestM(NULL) {
     }
     this->nMovies = 0;
     this->setupD(); // Also set nMovies to something sensible
-    assert(this-nMovies > 0);
+    if (conf.getIntAsBool("cofi.moviephase.itemMajor")) {
+        // For the movie phase, built here before any thread reads D
+        trainD->buildColumnIndex();
+    }
+    assert(this->nMovies > 0);
     const size_t nUsers = trainD->size1();
 
     // Setup M
@@ -120,37 +149,61 @@ cofi::UserIterator cofi::Problem::getTestIterator(void) {
 }
 
 
+namespace {
+
+    /**
+     * Loads a data file, through its binary cache if cofibmrm.cacheD is set.
+     */
+    void loadD(const std::string& filename, cofi::io::CSRData& data, const size_t nThreads) {
+        if (Configuration::getInstance().getInt("cofibmrm.cacheD")) {
+            cofi::io::loadSVMLightCached(filename, data, nThreads);
+        } else {
+            cofi::io::loadSVMLight(filename, data, nThreads);
+        }
+    }
+}
+
+
 void cofi::Problem::setupD(void) {
     Configuration& conf = Configuration::getInstance();
     const std::string testFileName = conf.getString("cofibmrm.DtestFile");
     const std::string trainFileName = conf.getString("cofibmrm.DtrainFile");
+    const size_t nThreads = cofi::parallel::getNumberOfThreads();
 
-    std::pair<size_t, size_t> trainDims = cofi::io::getDimensions<cofi::DType > (trainFileName);
-    std::pair<size_t, size_t> testDims = cofi::io::getDimensions<cofi::DType > (testFileName);
+    std::clog << "Problem: Reading train data from " << trainFileName << std::endl;
+    cofi::io::CSRData train;
+    loadD(trainFileName, train, nThreads);
+    std::clog << "Problem: Reading test data from " << testFileName << std::endl;
+    cofi::io::CSRData test;
+    loadD(testFileName, test, nThreads);
 
-    const size_t rows = trainDims.first;
-    assert(rows == testDims.first);
-    this->nMovies = std::max(testDims.second, trainDims.second);
+    const size_t rows = train.size1();
+    assert(rows == test.size1());
+    this->nMovies = std::max(test.size2(), train.size2());
 
     std::clog << "Problem:: we have " << rows << " rows and " << nMovies << " columns in D" << std::endl;
 
     if (getEvaluationMode() == STRONG) {
+        // Kept for switchToStrongGeneralization(), they are needed here for
+        // their number of columns
         const std::string testStrongFileName = conf.getString("cofibmrm.DtestStrongFile");
         const std::string trainStrongFileName = conf.getString("cofibmrm.DtrainStrongFile");
-        std::pair<size_t, size_t> trainStrongDims = cofi::io::getDimensions<cofi::DType > (trainStrongFileName);
-        std::pair<size_t, size_t> testStrongDims = cofi::io::getDimensions<cofi::DType > (testStrongFileName);
-        assert(trainStrongDims.first == testStrongDims.first);
-        size_t n = std::max<size_t > (trainStrongDims.second, testStrongDims.second);
+        std::clog << "Problem: Reading Strong Generalization train data from " << trainStrongFileName << std::endl;
+        this->trainStrong = new cofi::io::CSRData();
+        loadD(trainStrongFileName, *trainStrong, nThreads);
+        std::clog << "Problem: Reading Strong Generalization test data from " << testStrongFileName << std::endl;
+        this->testStrong = new cofi::io::CSRData();
+        loadD(testStrongFileName, *testStrong, nThreads);
+        assert(trainStrong->size1() == testStrong->size1());
+        size_t n = std::max<size_t > (trainStrong->size2(), testStrong->size2());
         this->nMovies = std::max<size_t > (this->nMovies, n);
     }
 
-    std::clog << "Problem: Reading train data from " << trainFileName << std::endl;
-    this->trainD = new cofi::DType(rows, nMovies);
-    cofi::io::loadMatrixWithOutResize(*(this->trainD), trainFileName);
+    this->trainD = new cofi::DType();
+    train.moveTo(*(this->trainD), rows, nMovies);
 
-    std::clog << "Problem: Reading test data from " << testFileName << std::endl;
-    this->testD = new cofi::DType(rows, nMovies);
-    cofi::io::loadMatrixWithOutResize(*(this->testD), testFileName);
+    this->testD = new cofi::DType();
+    test.moveTo(*(this->testD), rows, nMovies);
 }
 
 
@@ -161,23 +214,20 @@ void cofi::Problem::switchToStrongGeneralization(void) {
     if (testD) delete testD;
     if (U) delete U;
 
-    Configuration& conf = Configuration::getInstance();
-    const std::string testFileName = conf.getString("cofibmrm.DtestStrongFile");
-    const std::string trainFileName = conf.getString("cofibmrm.DtrainStrongFile");
-
-
-    std::pair<size_t, size_t> trainDims = cofi::io::getDimensions<cofi::DType > (trainFileName);
-    std::pair<size_t, size_t> testDims = cofi::io::getDimensions<cofi::DType > (testFileName);
-    const size_t rows = trainDims.first;
-    assert(rows == testDims.second);
+    // Loaded by setupD()
+    assert(trainStrong != NULL && testStrong != NULL);
+    const size_t rows = trainStrong->size1();
+    assert(rows == testStrong->size1());
 
-    std::clog << "Problem: Reading Strong Generalization train data from the SVMLIGHT file " << trainFileName << std::endl;
-    this->trainD = new cofi::DType(rows, this->nMovies);
-    cofi::io::loadMatrixWithOutResize(*(this->trainD), trainFileName);
+    this->trainD = new cofi::DType();
+    trainStrong->moveTo(*(this->trainD), rows, this->nMovies);
+    delete trainStrong;
+    trainStrong = NULL;
 
-    std::clog << "Problem: Reading Strong Generalization test data from the SVMLIGHT file " << testFileName << std::endl;
-    this->testD = new cofi::DType(rows, this->nMovies);
-    cofi::io::loadMatrixWithOutResize(*(this->testD), testFileName);
+    this->testD = new cofi::DType();
+    testStrong->moveTo(*(this->testD), rows, this->nMovies);
+    delete testStrong;
+    testStrong = NULL;
 
 
     const size_t nUsers = trainD->size1();
@@ -220,21 +270,16 @@ void cofi::Problem::computeWeights(const Real exponent) {
     this->weightsU.clear(); // make it empty
 
     // Count the seen movies.
-    typedef cofi::DType::iterator1 rowIterator;
-    typedef cofi::DType::iterator2 columnIterator;
-
     Real maxCount = 0;
 
-    for (rowIterator i1 = trainD->begin1(); i1 != trainD->end1(); ++i1) {
-        for (columnIterator i2 = i1.begin(); i2 != i1.end(); ++i2) {
-            const size_t user = i2.index1();
-            weightsU[user] += 1;
-            maxCount = std::max<Real > (maxCount, weightsU[user]);
-        }
+    for (size_t user = 0; user < trainD->size1(); ++user) {
+        weightsU[user] = static_cast<Real> (trainD->rowSize(user));
+        maxCount = std::max<Real > (maxCount, weightsU[user]);
     }
 
     // Normalize the counts
     weightsU /= maxCount;
+    this->maxRatingsPerUser = maxCount;
 
     // Exponentiate the entries with the factor
     for (size_t i = 0; i < weightsU.size(); ++i) {
@@ -245,42 +290,50 @@ void cofi::Problem::computeWeights(const Real exponent) {
 
 
 void cofi::Problem::setupS(void) {
-    S = new SType(testD->size1(), testD->size2());
-    S->clear();
-    for (DType::iterator1 row = trainD->begin1(); row != trainD->end1(); ++row) {
-        Real count = 0;
-        for (DType::iterator2 col = row.begin(); col != row.end(); ++col) {
-            count += 1.0;
-        }
-        for (DType::iterator2 col = row.begin(); col != row.end(); ++col) {
-            (*S)(col.index1(), col.index2()) = 1.0 / count;
+    S = new SType(testD->size1(), testD->size2(), trainD->nnz());
+    // The entries are appended in order, which does not need to search
+    for (size_t row = 0; row < trainD->size1(); ++row) {
+        const Real count = static_cast<Real> (trainD->rowSize(row));
+        for (size_t e = trainD->rowBegin(row); e < trainD->rowEnd(row); ++e) {
+            S->push_back(row, trainD->column(e), 1.0 / count);
         }
     }
 }
 
 
 void cofi::Problem::save(std::string prefix) {
-    std::clog << "cofi::Problem::save(): Save is disabled. " << std::endl;
-    //
-    //    Configuration& conf = Configuration::getInstance();
-    //    const std::string& outFolder = conf.getString("cofi.outfolder");
-    //    // Store U, M
-    //    std::clog << "Storing trained F, U and M" << std::endl;
-    //    if (conf.getIntAsBool("cofi.storeU")) {
-    //        cofi::io::storeMatrix<cofi::UType > (*U, outFolder + "U_" + prefix + ".lsvm");
-    //        if (usingGraphKernel()) {
-    //            cofi::io::storeMatrix<cofi::SType > (*S, outFolder + "S_" + prefix + ".lsvm");
-    //            cofi::io::storeMatrix<ublas::matrix<Real> >(*A, outFolder + "A_" + prefix + ".lsvm");
-    //        }
-    //    }
-    //    if (conf.getIntAsBool("cofi.storeM")) {
-    //        cofi::io::storeMatrix<cofi::MType > (*M, outFolder + "M_" + prefix + ".lsvm");
-    //        if (bestM)
-    //            cofi::io::storeMatrix<cofi::MType > (*bestM, outFolder + "M_best_" + prefix + ".lsvm");
-    //    }
-    //    if (conf.getIntAsBool("cofi.storeF")) {
-    //        ublas::matrix<Real> F = prod(*U, trans(*M));
-    //        cofi::io::storeMatrix<ublas::matrix<Real> >(F, outFolder + "F_" + prefix + ".lsvm");
-    //    }
+    Configuration& conf = Configuration::getInstance();
+    const std::string& outFolder = conf.getString("cofi.outfolder");
+    if (conf.getInt("cofi.storeModel") == 1) {
+        const std::string modelFile = outFolder + "model_" + prefix + ".bin";
+        std::clog << "cofi::Problem::save(): Storing the model in " << modelFile << std::endl;
+        cofi::io::ModelWriter model(modelFile, conf.getInt("cofi.storeModel.float") == 1);
+        model.add("U", *U);
+        model.add("M", *M);
+        if (usingGraphKernel()) {
+            model.add("A", *A);
+        }
+        if (bestM) {
+            model.add("bestM", *bestM);
+        }
+        if (!usingGraphKernel()) {
+            model.add("settings", cofi::FoldInSettings::fromConfiguration(*this).toMatrix());
+        }
+        model.close();
+    }
+    if (conf.getInt("cofi.storeF") == 1) {
+        const std::string topKFile = outFolder + "F_" + prefix + ".topk";
+        std::clog << "cofi::Problem::save(): Storing the top predictions in " << topKFile << std::endl;
+        const size_t nThreads = cofi::parallel::getNumberOfThreads();
+        cofi::Recommender recommender(*U, *M);
+        recommender.setExcluded(trainD);
+        const cofi::ItemIndex* index = NULL;
+        if (conf.getInt("cofi.storeF.index.lists") > 0) {
+            index = new cofi::ItemIndex(*M, conf.getInt("cofi.storeF.index.lists"), cofi::ItemIndex::DEFAULT_ITERATIONS, nThreads);
+            recommender.setIndex(index, conf.getInt("cofi.storeF.index.probes"));
+        }
+        recommender.store(conf.getInt("cofi.storeF.k"), topKFile, nThreads);
+        delete index;
+    }
 }
 
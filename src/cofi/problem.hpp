@@ -30,6 +30,9 @@ namespace cofi{
     
     // Forward declaration.
     class UserIterator;
+    namespace io {
+        class CSRData;
+    }
     
     enum EvaluationMode{STRONG, WEAK};
     /**
@@ -60,10 +63,22 @@ namespace cofi{
         Problem(void);
         
         /**
-         * Will delete D, M, U
+         * Will delete D, M, U. A snapshot only deletes its U, M and A.
          */
         ~Problem(void);
         
+        /**
+         * Takes a snapshot of the current state.
+         *
+         * The snapshot has its own copies of U, M and A and shares the data
+         * (D and S) with this Problem, which must not change or be deleted
+         * before the snapshot. Hence, it may not outlive
+         * switchToStrongGeneralization().
+         *
+         * @return the snapshot. The caller owns it.
+         */
+        Problem* snapshot(void);
+        
         /**
          * @return a UserIterator over the training data
          */
@@ -112,8 +127,8 @@ namespace cofi{
         /**
          * Switches to strong generalization phase.
          *
-         * rereads the train- and testmatrix for strong generalization and
-         * reads or creates a new U.
+         * Takes the train- and testmatrix for strong generalization, as
+         * loaded by the constructor, and creates a new U.
          *
          */
         void switchToStrongGeneralization(void);
@@ -146,6 +161,12 @@ namespace cofi{
          * @return the weight for the row i in U. Used for the adaptive regulariser.
          */
         Real getWeightForU(const size_t i){return weightsU[i];};
+
+        /**
+         * @return the largest number of ratings of a user, which the weights
+         *         for U are relative to. Used for the adaptive regulariser.
+         */
+        Real getMaxRatingsPerUser(void){return maxRatingsPerUser;}
         
         /**
          * @return the number of features to learn.
@@ -198,6 +219,15 @@ namespace cofi{
         }
         
     private:
+        /**
+         * Creates a snapshot of other, see snapshot().
+         */
+        Problem(const Problem& other);
+        
+        // Not implemented
+        Problem& operator=(const Problem& other);
+        
+        bool ownsData;                  // False for snapshots, which share D and S
         bool useMovieOffset;            // Whether or not to use the movie offset
         bool useUserOffset;             // Whether or not to use the user offset
         bool useGraphKernel;            // Graph Kernel trick
@@ -215,6 +245,8 @@ namespace cofi{
         cofi::DType* trainD;            // Train ratings
         cofi::DType* testD;             // Test ratings
         cofi::SType* S;                 // S[i,j] is 1 iff the user i saw movie j
+        cofi::io::CSRData* trainStrong; // The STRONG ratings until switchToStrongGeneralization()
+        cofi::io::CSRData* testStrong;
         
         
         /**
@@ -231,6 +263,7 @@ namespace cofi{
          */
         size_t nMovies;                        // Number of movies (max over train and test)
         ublas::vector<Real> weightsU;          // weightsU[i] := The weights for user i
+        Real maxRatingsPerUser;                // The number of ratings weightsU is relative to
         
         /**
          * Reads D from the filesystem.
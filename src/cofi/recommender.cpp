@@ -0,0 +1,235 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "recommender.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "core/cofiexception.hpp"
+#include "io/bufferedwriter.hpp"
+#include "cofi/itemindex.hpp"
+#include "utils/parallel.hpp"
+
+namespace {
+
+    /**
+     * The items excluded for one user, sorted, with a cursor that follows the
+     * items as they are scored in increasing order.
+     */
+    struct ExcludedItems {
+        std::vector<cofi::itemid> items;
+        size_t cursor;
+
+        bool contains(const cofi::itemid item) {
+            while (cursor < items.size() && items[cursor] < item) {
+                ++cursor;
+            }
+            return cursor < items.size() && items[cursor] == item;
+        }
+    };
+
+
+    /**
+     * The scratch space of one thread.
+     */
+    struct Workspace {
+        std::vector<ExcludedItems> excluded;
+        cofi::ItemIndex::Workspace index;
+    };
+
+
+    /**
+     * Scores the users of one block per index against all items.
+     */
+    class RecommendTask : public cofi::parallel::RangeTask {
+    public:
+
+        RecommendTask(const cofi::UType& U, const cofi::MType& M, const cofi::DType* excluded,
+                const cofi::ItemIndex* index, const size_t nProbe, const size_t first, const size_t last, const size_t k,
+                std::vector<std::vector<cofi::Recommendation> >& result, const size_t nThreads) :
+        U(U), M(M), excluded(excluded), index(index), nProbe(nProbe), first(first), last(last), k(k), result(result), workspaces(nThreads) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            for (size_t block = begin; block < end; ++block) {
+                processBlock(block, workspaces[thread]);
+            }
+        }
+
+    private:
+
+        void processBlock(const size_t block, Workspace& workspace) {
+            std::vector<ExcludedItems>& ws = workspace.excluded;
+            const size_t userBegin = first + block * cofi::Recommender::USER_BLOCK;
+            const size_t userEnd = std::min(last, userBegin + cofi::Recommender::USER_BLOCK);
+            const size_t nUsers = userEnd - userBegin;
+            const size_t nItems = M.size1();
+            const size_t dim = M.size2();
+
+            ws.resize(nUsers);
+            for (size_t i = 0; i < nUsers; ++i) {
+                ws[i].items.clear();
+                ws[i].cursor = 0;
+                const size_t user = userBegin + i;
+                if (excluded != NULL && user < excluded->size1()) {
+                    for (size_t e = excluded->rowBegin(user); e < excluded->rowEnd(user); ++e) {
+                        ws[i].items.push_back(excluded->column(e));
+                    }
+                }
+                result[user - first].clear();
+                result[user - first].reserve(k);
+            }
+
+            if (index != NULL) {
+                for (size_t i = 0; i < nUsers; ++i) {
+                    const size_t user = userBegin + i;
+                    const Real* u = M.size2() > 0 ? &U.data()[0] + user * M.size2() : NULL;
+                    index->search(u, k, nProbe, ws[i].items, result[user - first], workspace.index);
+                }
+                return;
+            }
+
+            const Real* mData = dim > 0 ? &M.data()[0] : NULL;
+            for (size_t tile = 0; tile < nItems; tile += cofi::Recommender::ITEM_BLOCK) {
+                const size_t tileEnd = std::min(nItems, tile + cofi::Recommender::ITEM_BLOCK);
+                for (size_t i = 0; i < nUsers; ++i) {
+                    const size_t user = userBegin + i;
+                    const Real* u = dim > 0 ? &U.data()[0] + user * dim : NULL;
+                    std::vector<cofi::Recommendation>& heap = result[user - first];
+                    size_t item = tile;
+                    // Four items at a time, so that the row of U is loaded
+                    // once for four rows of M
+                    for (; item + 4 <= tileEnd; item += 4) {
+                        const Real* m0 = mData + item * dim;
+                        const Real* m1 = m0 + dim;
+                        const Real* m2 = m1 + dim;
+                        const Real* m3 = m2 + dim;
+                        Real s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                        for (size_t d = 0; d < dim; ++d) {
+                            const Real ud = u[d];
+                            s0 += ud * m0[d];
+                            s1 += ud * m1[d];
+                            s2 += ud * m2[d];
+                            s3 += ud * m3[d];
+                        }
+                        offer(heap, ws[i], item, s0);
+                        offer(heap, ws[i], item + 1, s1);
+                        offer(heap, ws[i], item + 2, s2);
+                        offer(heap, ws[i], item + 3, s3);
+                    }
+                    for (; item < tileEnd; ++item) {
+                        const Real* m = mData + item * dim;
+                        Real s = 0.0;
+                        for (size_t d = 0; d < dim; ++d) {
+                            s += u[d] * m[d];
+                        }
+                        offer(heap, ws[i], item, s);
+                    }
+                }
+            }
+
+            for (size_t user = userBegin; user < userEnd; ++user) {
+                std::sort_heap(result[user - first].begin(), result[user - first].end(), cofi::BetterRecommendation());
+            }
+        }
+
+
+        /**
+         * Adds the item to the heap, if it is among the k best so far and not
+         * excluded.
+         */
+        void offer(std::vector<cofi::Recommendation>& heap, ExcludedItems& ex, const cofi::itemid item, const Real score) {
+            cofi::Recommendation r;
+            r.item = item;
+            r.score = score;
+            const bool full = heap.size() == k;
+            if (full && !cofi::BetterRecommendation()(r, heap.front())) {
+                return;
+            }
+            if (ex.contains(item)) {
+                return;
+            }
+            if (full) {
+                std::pop_heap(heap.begin(), heap.end(), cofi::BetterRecommendation());
+                heap.back() = r;
+            } else {
+                heap.push_back(r);
+            }
+            std::push_heap(heap.begin(), heap.end(), cofi::BetterRecommendation());
+        }
+
+        const cofi::UType& U;
+        const cofi::MType& M;
+        const cofi::DType* excluded;
+        const cofi::ItemIndex* index;
+        const size_t nProbe;
+        const size_t first;
+        const size_t last;
+        const size_t k;
+        std::vector<std::vector<cofi::Recommendation> >& result;
+        std::vector<Workspace> workspaces;
+    };
+}
+
+
+cofi::Recommender::Recommender(const cofi::UType& U, const cofi::MType& M) : U(U), M(M), excluded(NULL), index(NULL), nProbe(0) {
+    if (U.size2() != M.size2()) {
+        throw CoFiException("Recommender: U and M differ in their number of columns");
+    }
+}
+
+
+void cofi::Recommender::recommend(const size_t first, const size_t last, const size_t k,
+        std::vector<std::vector<Recommendation> >& result, const size_t nThreads) const {
+    assert(first <= last && last <= U.size1());
+    result.resize(last - first);
+    if (k == 0) {
+        for (size_t i = 0; i < result.size(); ++i) {
+            result[i].clear();
+        }
+        return;
+    }
+    const size_t nBlocks = (last - first + USER_BLOCK - 1) / USER_BLOCK;
+    const size_t workers = std::max<size_t > (1, std::min(nThreads, nBlocks));
+    RecommendTask task(U, M, excluded, index, nProbe, first, last, k, result, workers);
+    cofi::parallel::forEach(task, nBlocks, workers);
+}
+
+
+void cofi::Recommender::store(const size_t k, const std::string& filename, const size_t nThreads) const {
+    // Enough users per batch to keep all threads busy, few enough to bound
+    // the memory for the results.
+    const size_t batch = 64 * USER_BLOCK;
+    std::vector<std::vector<Recommendation> > result;
+    cofi::io::BufferedWriter out(filename);
+    for (size_t first = 0; first < U.size1(); first += batch) {
+        const size_t last = std::min(U.size1(), first + batch);
+        recommend(first, last, k, result, nThreads);
+        for (size_t i = 0; i < result.size(); ++i) {
+            for (size_t j = 0; j < result[i].size(); ++j) {
+                // +1, as the files all start with column 1
+                out.writeIndex(result[i][j].item + 1);
+                out.write(':');
+                out.writeReal(result[i][j].score);
+                out.write(' ');
+            }
+            out.write('\n');
+        }
+    }
+    out.close();
+}
@@ -0,0 +1,132 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _RECOMMENDER_HPP_
+#define _RECOMMENDER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace cofi {
+
+    /**
+     * An item recommended to a user together with its score.
+     */
+    struct Recommendation {
+        itemid item;
+        Real score;
+    };
+
+
+    /**
+     * Orders recommendations by decreasing score, ties by increasing item.
+     *
+     * As the comparison of a heap, it keeps the worst recommendation in front.
+     */
+    struct BetterRecommendation {
+
+        bool operator()(const Recommendation& a, const Recommendation& b) const {
+            return a.score > b.score || (a.score == b.score && a.item < b.item);
+        }
+    };
+
+
+    class ItemIndex;
+
+
+    /**
+     * Retrieves the k highest scoring items of users from trained U and M,
+     * where the score of item j for user i is the inner product of row i of
+     * U and row j of M.
+     *
+     * The scores are never formed as a matrix: Users are processed in blocks
+     * of USER_BLOCK and the items in tiles of ITEM_BLOCK, such that a tile of
+     * M stays in the cache while it is scored against all users of a block.
+     * Every score goes straight into a bounded heap of the k best items of
+     * its user. The user blocks are distributed over threads.
+     *
+     * Alternatively, the items can be retrieved approximately from an
+     * ItemIndex over M, see setIndex().
+     */
+    class Recommender {
+    public:
+        static const size_t USER_BLOCK = 64;
+        static const size_t ITEM_BLOCK = 256;
+
+
+        /**
+         * U and M have to stay alive and unchanged while this object is used.
+         *
+         * @throws CoFiException if U and M differ in their number of columns.
+         */
+        Recommender(const cofi::UType& U, const cofi::MType& M);
+
+
+        /**
+         * Excludes the items of row i of the given matrix from the
+         * recommendations to user i, typically the training ratings. NULL
+         * excludes nothing. The matrix has to stay alive while this object is
+         * used.
+         */
+        void setExcluded(const cofi::DType* excluded) {
+            this->excluded = excluded;
+        }
+
+
+        /**
+         * Retrieves the items from the given index over M, probing nProbe of
+         * its lists per user, instead of scoring all of them. NULL restores
+         * the exhaustive scoring. The index has to stay alive while this
+         * object is used.
+         */
+        void setIndex(const ItemIndex* index, const size_t nProbe) {
+            this->index = index;
+            this->nProbe = nProbe;
+        }
+
+
+        /**
+         * Computes the recommendations for the users [first, last).
+         *
+         * @param result result[i] holds the at most k best items of user
+         *        first+i, in decreasing order of their score. Ties are broken
+         *        by the smaller item index.
+         */
+        void recommend(const size_t first, const size_t last, const size_t k,
+                std::vector<std::vector<Recommendation> >& result, const size_t nThreads) const;
+
+
+        /**
+         * Writes the k best items of every user to the given file.
+         *
+         * Line i of the file holds the items of user i as item:score pairs,
+         * with items counted from 1 as in the input files.
+         *
+         * @throws CoFiException if the file cannot be written.
+         */
+        void store(const size_t k, const std::string& filename, const size_t nThreads) const;
+
+    private:
+        const cofi::UType& U;
+        const cofi::MType& M;
+        const cofi::DType* excluded;
+        const ItemIndex* index;
+        size_t nProbe;
+    };
+}
+#endif /* _RECOMMENDER_HPP_ */
@@ -1,23 +1,136 @@
 #include "solver.hpp"
 #include <bmrm/bmrm.hpp>
+#include <bmrm/lbfgs.hpp>
+#include <bmrm/subgradient.hpp>
 #include <core/cofiexception.hpp>
+#include <iostream>
+
+
+namespace {
+    // Whether the warning about a nonsmooth loss was given already
+    bool warnedNonsmooth = false;
+}
 
 
 cofi::Solver::Solver(void) {
+    // Configuring the solver is done once per phase i.e. user/movie. This also
+    // keeps the configuration out of the (possibly multi-threaded) user phase.
+    Configuration& conf = Configuration::getInstance();
+    gammaTol = conf.getDouble("bmrm.minProgress");
+    epsilonTol = conf.getDouble("bmrm.minOptimProgress");
+    maxIter = conf.getInt("bmrm.maxNumberOfIterations");
+    relGammaTol = conf.getDouble("bmrm.minRelativeProgress");
+    relEpsilonTol = conf.getDouble("bmrm.minRelativeOptimProgress");
+    innerSolverSettings = readInnerSolverSettings();
+    const int planes = conf.getInt("bmrm.warmStartPlanes");
+    if (planes < 0) {
+        throw InvalidParameterException("Solver: bmrm.warmStartPlanes must not be negative");
+    }
+    warmStartPlanes = planes;
+
+    choosenSolver = readSolver();
+    // LBFGS assumes a smooth objective, and the subgradient method has no
+    // stopping criterion of its own. Neither is guaranteed to converge on the
+    // piecewise linear losses.
+    const std::string loss = conf.getString("cofi.loss");
+    if (choosenSolver != bmrm && loss != "REGRESSION" && !warnedNonsmooth) {
+        std::clog << "WARNING: Solver: cofi.solver " << conf.getString("cofi.solver") << " is meant for the smooth loss REGRESSION. It is not guaranteed to converge on the nonsmooth "
+                << loss << " loss; BMRM is." << std::endl;
+        warnedNonsmooth = true;
+    }
+    const int memory = conf.getInt("lbfgs.memory");
+    if (memory < 1) {
+        throw InvalidParameterException("Solver: lbfgs.memory has to be positive");
+    }
+    lbfgsMemory = memory;
+    lbfgsMinRelativeProgress = conf.getDouble("lbfgs.minRelativeProgress");
+    lbfgsMaxIter = conf.getInt("lbfgs.maxNumberOfIterations");
+    subgradientStepSize = conf.getDouble("subgradient.initialStepSize");
+    if (subgradientStepSize <= 0) {
+        throw InvalidParameterException("Solver: subgradient.initialStepSize has to be positive");
+    }
+    subgradientMinRelativeProgress = conf.getDouble("subgradient.minRelativeProgress");
+    subgradientMaxIter = conf.getInt("subgradient.maxNumberOfIterations");
 }
 
 
-Real cofi::Solver::optimize(cofi::WType& w, LossFunction& loss, const Real lambda, const size_t t, ublas::matrix<Real>* X, ublas::matrix<Real>* Y) {
-    // should we but this in the constructor ?
-    // configuring the solver should be done once per phase i.e. user/movie
+cofi::Solver::Solver(const double gammaTol, const double epsilonTol, const double relGammaTol, const double relEpsilonTol, const int maxIter,
+        const DualInnerSolverSettings& innerSolverSettings) :
+choosenSolver(bmrm), gammaTol(gammaTol), epsilonTol(epsilonTol), relGammaTol(relGammaTol), relEpsilonTol(relEpsilonTol), maxIter(maxIter),
+innerSolverSettings(innerSolverSettings), warmStartPlanes(0),
+lbfgsMemory(0), lbfgsMinRelativeProgress(0), lbfgsMaxIter(0), subgradientStepSize(0), subgradientMinRelativeProgress(0), subgradientMaxIter(0) {
+}
+
+
+DualInnerSolverSettings cofi::Solver::readInnerSolverSettings(void) {
     Configuration& conf = Configuration::getInstance();
+    DualInnerSolverSettings s;
+    s.maxGradSetSize = conf.getInt("DualInnerSolver.maxGradSetSize");
+    s.gradIdleAge = conf.getInt("DualInnerSolver.gradIdleAge");
+    s.removeAllIdleGradients = conf.getInt("DualInnerSolver.removeAllIdleGradients") == 1;
+    s.maxBundleBytes = conf.getDouble("DualInnerSolver.maxBundleMB") * 1024 * 1024;
+    s.singlePrecision = conf.getInt("DualInnerSolver.singlePrecision") == 1;
+    s.maxProjIter = conf.getInt("DaiFletcherPGM.maxProjIter");
+    s.maxPGMIter = conf.getInt("DaiFletcherPGM.maxPGMIter");
+    s.simd = conf.getInt("DaiFletcherPGM.simd") == 1;
+    if (s.maxGradSetSize < 2) {
+        throw InvalidParameterException("Solver: DualInnerSolver.maxGradSetSize has to be at least 2");
+    }
+    if (s.maxBundleBytes < 0) {
+        throw InvalidParameterException("Solver: DualInnerSolver.maxBundleMB must not be negative");
+    }
+    if (s.maxProjIter < 1 || s.maxPGMIter < 1) {
+        throw InvalidParameterException("Solver: DaiFletcherPGM.maxProjIter and DaiFletcherPGM.maxPGMIter have to be positive");
+    }
+    return s;
+}
+
+
+cofi::Solver::Solvers cofi::Solver::readSolver(void) {
+    const std::string solver = Configuration::getInstance().getString("cofi.solver");
+    if (solver == "BMRM") {
+        return bmrm;
+    } else if (solver == "LBFGS") {
+        return lbfgs;
+    } else if (solver == "SUBGRADIENT") {
+        return subgradient;
+    }
+    throw InvalidParameterException("Solver: cofi.solver has to be one of BMRM, LBFGS or SUBGRADIENT");
+}
+
 
+void cofi::Solver::useLBFGS(const size_t memory, const double minRelativeProgress, const int maxIter) {
+    choosenSolver = lbfgs;
+    lbfgsMemory = memory;
+    lbfgsMinRelativeProgress = minRelativeProgress;
+    lbfgsMaxIter = maxIter;
+}
+
+
+void cofi::Solver::useSubgradient(const double stepSize, const double minRelativeProgress, const int maxIter) {
+    choosenSolver = subgradient;
+    subgradientStepSize = stepSize;
+    subgradientMinRelativeProgress = minRelativeProgress;
+    subgradientMaxIter = maxIter;
+}
 
-    const double _gammaTol = conf.getDouble("bmrm.minProgress");
-    const double _epsilonTol = conf.getDouble("bmrm.minOptimProgress");
-    const int _maxIter = conf.getInt("bmrm.maxNumberOfIterations");
-    const double _relGammaTol = conf.getDouble("bmrm.minRelativeProgress");
-    const double _relEpsilonTol = conf.getDouble("bmrm.minRelativeOptimProgress");
+
+Real cofi::Solver::optimize(cofi::WType& w, LossFunction& loss, const Real lambda, const size_t t, ublas::matrix<Real>* X, ublas::matrix<Real>* Y,
+        BMRMWarmStart* warmStart) {
+    if (choosenSolver == lbfgs) {
+        LBFGS l(loss, lambda);
+        l.setConvergence(lbfgsMemory, lbfgsMinRelativeProgress, lbfgsMaxIter);
+        const Real result = l.train(w);
+        l.addStatistics(statistics);
+        return result;
+    }
+    if (choosenSolver == subgradient) {
+        Subgradient s(loss, lambda);
+        s.setConvergence(subgradientStepSize, subgradientMinRelativeProgress, subgradientMaxIter);
+        const Real result = s.train(w);
+        s.addStatistics(statistics);
+        return result;
+    }
 
     size_t dimW2 = 0;
     // dimW2 should reflect the dimension of w
@@ -27,10 +140,13 @@ Real cofi::Solver::optimize(cofi::WType& w, LossFunction& loss, const Real lambd
         dimW2 = w.size1() * w.size2();
     }
 
-    BMRM b(loss, lambda, dimW2);
-    b.setConvergence(_gammaTol, _epsilonTol, _relEpsilonTol, _relGammaTol, _maxIter);
+    BMRM b(loss, lambda, dimW2, innerSolverSettings);
+    b.setConvergence(gammaTol, epsilonTol, relEpsilonTol, relGammaTol, maxIter);
+    b.setWarmStart(warmStart, warmStartPlanes);
 
-    return b.train(w);
+    const Real result = b.train(w);
+    b.addStatistics(statistics);
+    return result;
 
 }
 
@@ -8,6 +8,8 @@
 #ifndef _SOLVER_H
 #define	_SOLVER_H
 #include <loss/cofilossfunction.hpp>
+#include <bmrm/bmrm.hpp>
+#include <bmrm/solver/dualinnersolver.hpp>
 #include "utils/configuration.hpp"
 #include <boost/numeric/ublas/matrix.hpp>
 
@@ -21,25 +23,108 @@ namespace cofi{
      * This class dispatches calls to solvers to their actual implementation.
      * CofiRank can use different solvers for the underlying convex optimization 
      * problems. This is the place where the selection of solvers is made based 
-     * on the configuration file.
+     * on the configuration file: cofi.solver is BMRM, LBFGS or SUBGRADIENT.
      *
      * @author Markus Weimer <cofirank@weimo.de>
      *
      */
     class Solver{
     public:
-        enum Solvers{bmrm, sgd, smd};
+        enum Solvers{bmrm, lbfgs, subgradient};
         Solver(void);
+
+        /**
+         * Uses the given BMRM convergence criteria and inner solver options
+         * instead of the configured ones.
+         */
+        Solver(const double gammaTol, const double epsilonTol, const double relGammaTol, const double relEpsilonTol, const int maxIter,
+                const DualInnerSolverSettings& innerSolverSettings = DualInnerSolverSettings());
+
+        /**
+         * @return the DualInnerSolver.* and DaiFletcherPGM.* options of the
+         *         configuration.
+         * @throws InvalidParameterException if one is out of its range.
+         */
+        static DualInnerSolverSettings readInnerSolverSettings(void);
+
+        /**
+         * @return the solver chosen by cofi.solver.
+         * @throws InvalidParameterException if it is none of BMRM, LBFGS or
+         *         SUBGRADIENT.
+         */
+        static Solvers readSolver(void);
+
+        /**
+         * Uses LBFGS with the given options instead of BMRM.
+         */
+        void useLBFGS(const size_t memory, const double minRelativeProgress, const int maxIter);
+
+        /**
+         * Uses the subgradient method with the given options instead of BMRM.
+         */
+        void useSubgradient(const double stepSize, const double minRelativeProgress, const int maxIter);
         ~Solver(void);
         
         /**
          * @param w the parameters to optimize.
          * @param loss the lossfunction to use.
          * @param lambda the regularizer factor
+         * @param warmStart the state of the last solve of this problem, which
+         *        is used and updated if bmrm.warmStartPlanes is positive.
+         */
+        Real optimize(cofi::WType& w, LossFunction& loss, const Real lambda, const size_t t, ublas::matrix<Real>* X = NULL, ublas::matrix<Real>* Y=NULL,
+                BMRMWarmStart* warmStart = NULL);
+
+        /**
+         * @return the number of points BMRM keeps between solves, 0 for cold
+         *         starts.
          */
-        Real optimize(cofi::WType& w, LossFunction& loss, const Real lambda, const size_t t, ublas::matrix<Real>* X = NULL, ublas::matrix<Real>* Y=NULL);
+        size_t getWarmStartPlanes(void) const {
+            return warmStartPlanes;
+        }
+
+        /**
+         * @return the time spent in the phases of all optimize() calls so far.
+         */
+        const BundleStatistics& getStatistics(void) const {
+            return statistics;
+        }
     private:
         Solvers choosenSolver;
+        BundleStatistics statistics;
+
+        /**
+         * The BMRM convergence criteria as read from the configuration.
+         */
+        double gammaTol;
+        double epsilonTol;
+        double relGammaTol;
+        double relEpsilonTol;
+        int maxIter;
+
+        /**
+         * The options of the bundle of BMRM.
+         */
+        DualInnerSolverSettings innerSolverSettings;
+
+        /**
+         * bmrm.warmStartPlanes
+         */
+        size_t warmStartPlanes;
+
+        /**
+         * The options of LBFGS, lbfgs.*
+         */
+        size_t lbfgsMemory;
+        double lbfgsMinRelativeProgress;
+        int lbfgsMaxIter;
+
+        /**
+         * The options of Subgradient, subgradient.*
+         */
+        double subgradientStepSize;
+        double subgradientMinRelativeProgress;
+        int subgradientMaxIter;
     };
 }
 
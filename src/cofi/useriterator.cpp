@@ -23,49 +23,72 @@
 #include "loss/lossfunctionfactory.hpp"
 #include "core/cofiexception.hpp"
 #include "loss/adaptiveregularizationlosswrapper.hpp"
+#include <algorithm>
 
 namespace ublas = boost::numeric::ublas;
 
 cofi::UserIterator::UserIterator(cofi::Problem& p, Phase phase):
 p(p), phase(phase),
-        X(NULL), Y(NULL), W(NULL), loss(NULL), weightedLoss(NULL) {
+        W(p.getDimW(), 1), loss(NULL), weightedLoss(NULL), lossIsCurrent(false), lossAllocations(0) {
     
-    if(phase == TRAINING){
-        dRows = p.getTrainD().begin1();
+    if(phase != TRAINING && phase != TESTING){
+        throw CoFiException("UserIterator::Phase should be either TRAINING or TESTING");
     }
-    else if (phase == TESTING){
-        dRows = p.getTestD().begin1();
-    }
-    else{throw CoFiException("UserIterator::Phase should be either TRAINING or TESTING");}
     if(p.usingGraphKernel()){
-        SA = prod(p.getS(), p.getA());
+        // SA = S*A from the nonzeros of S
+        const cofi::SType& S = p.getS();
+        const cofi::MType& A = p.getA();
+        SA.resize(p.getU().size1(), p.getDimW(), false);
+        SA.clear();
+        for (cofi::SType::const_iterator1 sRow = S.begin1(); sRow != S.end1(); ++sRow) {
+            for (cofi::SType::const_iterator2 s = sRow.begin(); s != sRow.end(); ++s) {
+                ublas::row(SA, s.index1()) += (*s) * ublas::row(A, s.index2());
+            }
+        }
         assert(SA.size1() == p.getU().size1());
         assert(SA.size2() == p.getU().size2());
     }
     
     nextRow = 0;
+
+    // Size the workspaces for the user with the most ratings
+    const cofi::DType& D = getD();
+    size_t maxRows = 0;
+    for (size_t i = 0; i < D.size1(); ++i) {
+        maxRows = std::max(maxRows, D.rowSize(i));
+    }
+    X.reserve(maxRows);
+    Y.data().reserve(maxRows);
+}
+
+
+cofi::UserIterator::UserIterator(const UserIterator& other):
+p(other.p), phase(other.phase), nextRow(other.nextRow),
+        W(other.W), loss(NULL), weightedLoss(NULL), lossIsCurrent(false), lossAllocations(0), SA(other.SA) {
+    Y.data().reserve(other.Y.data().capacity());
+    X = other.X;
+    Y = other.Y;
 }
 
 
 void cofi::UserIterator::updateW() {
-    row(p.getU(), getRowInU()) = column(*(this->W), 0);
+    row(p.getU(), getRowInU()) = column(this->W, 0);
 }
 
 
 cofi::UserIterator::~UserIterator(void) {
-    clear();
+    delete this->weightedLoss;
+    delete this->loss;
+}
+
+
+const cofi::DType& cofi::UserIterator::getD(void) {
+    return (phase == TRAINING) ? p.getTrainD() : p.getTestD();
 }
 
 
 bool cofi::UserIterator::hasNext(void) {
-    if(phase == TRAINING){
-        return dRows != p.getTrainD().end1();
-    }
-    else{
-        assert(phase == TESTING);
-        return dRows != p.getTestD().end1();
-    }
-    
+    return nextRow < getD().size1();
 }
 
 void cofi::UserIterator::advance(void) {
@@ -74,81 +97,87 @@ void cofi::UserIterator::advance(void) {
     const size_t userID = nextRow;
     this->nextRow += 1;
     
-    assert(dRows.index1() == userID);
-    
-    
-    // Clear X,Y,W,loss, countM
-    clear();
+    const cofi::DType& D = getD();
+    assert(userID < D.size1());
     
     // Setup
     // w = U[userID, *]
     
-    this->W = new cofi::WType(p.getDimW(), 1);
-    column(*(this->W), 0) = row(p.getU(), userID);
+    column(this->W, 0) = row(p.getU(), userID);
     if(p.usingGraphKernel()){
-        ublas::column(*(this->W), 0) += ublas::row(SA, userID);
+        ublas::column(this->W, 0) += ublas::row(SA, userID);
     }
     
     // -------------------------------------------------------------------------
-    // Setup X and Y as a dense problem.
+    // Setup X and Y.
     //
-    // This is done by extracting only those movies which the user has actually
-    // seen. Those rows of M will form X.
+    // X is a view on the rows of M for those movies which the user has
+    // actually seen. No data is copied, only the movie ids are recorded.
     //
     // The entries of D for these movies will form Y.
-    // const size_t rows = (*nonzeros)[userID].size();
-    size_t rows = 0;
-    for(colIteratorType cIter = dRows.begin(); cIter != dRows.end();++cIter){
-        ++rows;
-    }
-    
-    this->X = new ublas::matrix<Real>(rows, p.getDimW());
-    this->Y = new ublas::matrix<Real>(rows, 1);
+    const size_t first = D.rowBegin(userID);
+    const size_t rows = D.rowSize(userID);
     
+    this->X.setSource(p.getM());
+    this->X.resize(rows);
+    this->Y.resize(rows, 1, false);
     
-    colIteratorType columnIter = dRows.begin();
     for (size_t row = 0; row < rows ; ++row) {
-        const size_t movieID = columnIter.index2();
-        for (size_t col = 0; col < p.getDimW(); ++col) {
-            (*X)(row, col) = p.getM()(movieID, col);
-        }
-        (*Y)(row, 0) = *columnIter;
-        ++columnIter;
+        X.setIndex(row, D.column(first + row));
+        Y(row, 0) = D.value(first + row);
     }
-    assert(columnIter == dRows.end());
     
-    // Switch the iterator to the next line.
-    ++dRows;
+    lossIsCurrent = false;
+}
+
+
+void cofi::UserIterator::advanceTo(const size_t userID) {
+    assert(userID < getD().size1());
+    nextRow = userID;
+    advance();
 }
 
 
 CofiLossFunction& cofi::UserIterator::getLoss(void){
-    this->loss = LossFunctionFactory::getInstance().get(*X, *Y);
+    if (this->loss == NULL) {
+        this->loss = LossFunctionFactory::getInstance().get(X, Y);
+        ++lossAllocations;
+    } else if (!lossIsCurrent) {
+        this->loss->reset();
+    }
+    lossIsCurrent = true;
     return *(this->loss);
 }
 
 CofiLossFunction& cofi::UserIterator::getWeightedLoss(void){
     assert(p.usingAdaptiveRegularization());
     const Real weight = p.getWeightForU(getRowInU());
-    this->weightedLoss = new AdaptiveRegularizationLossWrapper(weight, getLoss());
+    CofiLossFunction& l = getLoss();
+    if (this->weightedLoss == NULL) {
+        this->weightedLoss = new AdaptiveRegularizationLossWrapper(weight, l);
+        ++lossAllocations;
+    } else {
+        this->weightedLoss->setWeight(weight);
+    }
     return *(this->weightedLoss);
 }
 
 
 cofi::WType& cofi::UserIterator::getW(void){
-    return *(this->W);
+    return this->W;
 }
 
 
 void cofi::UserIterator::predict(ublas::matrix<Real>& F){
-    getLoss().predict(getW(), getX(), F);
+    X.multiply(W, F);
+}
+
+
+void cofi::UserIterator::predict(cofi::YType& F){
+    X.multiply(W, F);
 }
 
 
-void cofi::UserIterator::clear(void) {
-    if(this->X)            delete this->X;
-    if(this->Y)            delete this->Y;
-    if(this->loss)         delete this->loss;
-    if(this->weightedLoss) delete this->weightedLoss;
-    if(this->W)            delete this->W;    
+size_t cofi::UserIterator::getNumberOfAllocations(void) const {
+    return X.allocations() + Y.data().allocations() + lossAllocations;
 }
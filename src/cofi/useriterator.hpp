@@ -27,6 +27,7 @@ namespace cofi{
     
     // Forward declaration.
     class Problem;
+    class AdaptiveRegularizationLossWrapper;
     /**
      * An iterator over the BMRM problems posed by the users.
      *
@@ -35,6 +36,12 @@ namespace cofi{
      *  extract the movies of M which that user has actually rated
      *  extract U[i] as w
      *  build Y such that Y[i] is the rating of the movie whose features are in X[i]
+     *
+     * X is a view on the rows of M, no features are copied. X, Y and W are
+     * workspaces owned by the iterator. They are sized for the user with the
+     * most ratings upon construction and refilled for every user, as is the
+     * loss function which is created once and reset for each user. Hence, advancing does not allocate memory once the first user
+     * has been set up, see getNumberOfAllocations().
      */
     class UserIterator {
     public:
@@ -45,9 +52,15 @@ namespace cofi{
          *
          */
         UserIterator(cofi::Problem& p, Phase phase);
+
+        /**
+         * Copies the position and the workspaces. The loss functions are not
+         * shared, the copy creates its own when needed.
+         */
+        UserIterator(const UserIterator& other);
         
         /**
-         * Deletes all temporary matrices created.
+         * Deletes the loss functions created.
          */
         ~UserIterator();
         
@@ -61,17 +74,27 @@ namespace cofi{
          */
         void advance(void);
         
+        /**
+         * Jumps to the given user and sets it up as the current one.
+         *
+         * Afterwards, advance() continues with the user after userID. This
+         * allows several iterators to work on disjoint sets of users.
+         *
+         * @param userID the row in D to jump to.
+         */
+        void advanceTo(const size_t userID);
+        
         /**
          * Gets the matrix X for the current user
          *
          * @return the matrix X for the current user
          */
-        inline ublas::matrix<Real>& getX(void) {return *X;}
+        inline cofi::XType& getX(void) {return X;}
         
         /**
          * @return the matrix Y for the current user
          */
-        inline ublas::matrix<Real>& getY(void) {return *Y;}
+        inline cofi::YType& getY(void) {return Y;}
         
         /**
          * @return the parameter vector for the current user.
@@ -80,7 +103,9 @@ namespace cofi{
 
         
         /**
-         * @return the loss function for the current user
+         * @return the loss function for the current user. It stays valid
+         *         until the iterator is destroyed, but always refers to the
+         *         current user.
          */
         CofiLossFunction& getLoss(void);
         
@@ -90,9 +115,11 @@ namespace cofi{
         CofiLossFunction& getWeightedLoss(void);
 
         /**
-         * Computes the current prediction into the given matrix F
+         * Computes the current prediction X*w into the given matrix F. All
+         * the losses predict this way, so no loss function is set up.
          */
         void predict(ublas::matrix<Real>& F);
+        void predict(cofi::YType& F);
         
         /**
          * @return the current row in U the iterator is pointing to
@@ -102,29 +129,38 @@ namespace cofi{
         }
         
         void updateW(void);
+
+        /**
+         * @return the number of memory allocations done for the workspaces and
+         *         loss functions since construction. In steady state, this does
+         *         not change when advancing.
+         */
+        size_t getNumberOfAllocations(void) const;
         
         
         
         
     private:
+        // Not implemented, the loss functions are owned.
+        UserIterator& operator=(const UserIterator& other);
+
         /**
-         * Deletes all interemediate structures. Namely:
-         * X, Y, W, loss
+         * @return the ratings of the phase.
          */
-        void clear(void);
+        const cofi::DType& getD(void);
+        
         Problem &p;
         const Phase phase;
         
-        typedef cofi::DType::iterator1 rowIteratorType;
-        typedef cofi::DType::iterator2 colIteratorType;
-        rowIteratorType dRows;
         size_t nextRow;
-        ublas::matrix<Real>* X;
-        ublas::matrix<Real>* Y;
-        cofi::WType* W;
+        cofi::XType X;
+        cofi::YType Y;
+        cofi::WType W;
         
         CofiLossFunction* loss;
-        CofiLossFunction* weightedLoss; // The loss which includes the weight
+        AdaptiveRegularizationLossWrapper* weightedLoss; // The loss which includes the weight
+        bool lossIsCurrent; // Whether loss has been reset for the current user
+        size_t lossAllocations;
         cofi::UType SA; // S times A
         
         
@@ -20,6 +20,94 @@
 #include "cofi/useriterator.hpp"
 #include "solver.hpp"
 #include "loss/userloss.hpp"
+#include "loss/lossfunctionfactory.hpp"
+#include "loss/leastsquaredomainmodel.hpp"
+#include "core/cofiexception.hpp"
+#include "utils/configuration.hpp"
+#include "utils/parallel.hpp"
+#include <vector>
+#include <iostream>
+
+namespace {
+
+    /**
+     * Solves the BMRM problems for a range of users.
+     *
+     * Each worker thread gets its own UserIterator and Solver. The problems
+     * of different users only share M (read only) and write to distinct rows
+     * of U. The loss of each user is stored per user such that run() can sum
+     * them up in the same order as a sequential pass would.
+     *
+     * With direct, the least squares problems are solved in closed form
+     * instead of by BMRM.
+     */
+    class UserPhaseTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        UserPhaseTask(cofi::Problem& p, const size_t t, const Real lambda, const bool direct, const size_t nThreads, std::vector<Real>& losses,
+                std::vector<BMRMWarmStart>& warmStarts) :
+        p(p), t(t), lambda(lambda), direct(direct), losses(losses), warmStarts(warmStarts) {
+            for (size_t i = 0; i < nThreads; ++i) {
+                iterators.push_back(new cofi::UserIterator(p, cofi::UserIterator::TRAINING));
+                solvers.push_back(new cofi::Solver());
+            }
+        }
+
+
+        ~UserPhaseTask(void) {
+            for (size_t i = 0; i < iterators.size(); ++i) {
+                delete iterators[i];
+                delete solvers[i];
+            }
+        }
+
+
+        /**
+         * @return the time the solvers of all threads spent in BMRM, and
+         *         the largest bundle of any of them.
+         */
+        BundleStatistics getStatistics(void) const {
+            BundleStatistics statistics;
+            for (size_t i = 0; i < solvers.size(); ++i) {
+                statistics.add(solvers[i]->getStatistics());
+            }
+            return statistics;
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            cofi::UserIterator& iter = *(iterators[thread]);
+            cofi::Solver& solver = *(solvers[thread]);
+            for (size_t user = begin; user < end; ++user) {
+                iter.advanceTo(user);
+                if (direct) {
+                    LeastSquareDomainModel& model = static_cast<LeastSquareDomainModel&> (iter.getLoss());
+                    const Real weight = p.usingAdaptiveRegularization() ? p.getWeightForU(user) : 1.0;
+                    const size_t offsetColumn = p.usingMovieOffset() ? cofi::MOVIE_OFFSET_COLUMN : p.getDimW();
+                    losses[user] = model.solve(iter.getW(), lambda, weight, offsetColumn);
+                    iter.updateW();
+                    continue;
+                }
+                CofiLossFunction& realLoss = p.usingAdaptiveRegularization() ? iter.getWeightedLoss() : iter.getLoss();
+                cofi::UserLoss loss(realLoss, p.usingMovieOffset());
+                BMRMWarmStart* warmStart = warmStarts.empty() ? NULL : &warmStarts[user];
+                losses[user] = solver.optimize(iter.getW(), loss, lambda, t, NULL, NULL, warmStart);
+                iter.updateW();
+            }
+        }
+
+    private:
+        cofi::Problem& p;
+        const size_t t;
+        const Real lambda;
+        const bool direct;
+        std::vector<Real>& losses;
+        std::vector<BMRMWarmStart>& warmStarts;
+        std::vector<cofi::UserIterator*> iterators;
+        std::vector<cofi::Solver*> solvers;
+    };
+}
 
 Real cofi::UserTrainer::run(cofi::Problem& p, size_t t, Real lambda) {
 #ifndef NDEBUG
@@ -39,31 +127,55 @@ Real cofi::UserTrainer::run(cofi::Problem& p, size_t t, Real lambda) {
 
         cofi::GraphKernelLossWrapper lossFunction(p);
         cofi::Solver solver;
-        const Real loss = solver.optimize(W, lossFunction, lambda, t);
+        const Real loss = solver.optimize(W, lossFunction, lambda, t, NULL, NULL, &graphKernelWarmStart);
+        statistics = solver.getStatistics();
+        const BundleStatistics& s = statistics;
+        std::clog << "UserTrainer::run: The graph kernel solver spent " << s.loss << "s in the loss, "
+                << s.update << "s updating the bundle, " << s.qp << "s in " << s.qpSolves << " QPs ("
+                << s.pgmIterations << " PGM iterations, " << s.projections << " projection steps), "
+                << s.solution << "s in the solution, the bundle took "
+                << s.peakBytes / (1024 * 1024) << "MB" << std::endl;
 
         // Copy W back into A and U
         p.getU() = ublas::subrange(W, 0, u, 0, d);
         p.getA() = ublas::subrange(W, u, u + m, 0, d);
         return loss;
     }else {
-        cofi::UserIterator iter = p.getTrainIterator();
-        Real lossSum = 0.0;
-        cofi::Solver solver;
-        while (iter.hasNext()) {
-            iter.advance();
-            LossFunction* loss = NULL;
-            if (p.usingAdaptiveRegularization()) {
-                loss = new UserLoss(iter.getWeightedLoss(), p.usingMovieOffset());
-            } else {
-                loss = new UserLoss(iter.getLoss(), p.usingMovieOffset());
+        // Create the singleton before the workers need it.
+        const LossFunctionFactory& factory = LossFunctionFactory::getInstance();
+        const bool direct = Configuration::getInstance().getInt("cofi.userphase.direct") == 1;
+        if (direct && factory.getModel() != LossFunctionFactory::REGRESSION) {
+            throw cofi::InvalidParameterException("UserTrainer: cofi.userphase.direct requires cofi.loss REGRESSION");
+        }
+
+        const size_t nUsers = p.getTrainD().size1();
+        const size_t nThreads = cofi::parallel::getNumberOfThreads();
+        std::vector<Real> losses(nUsers, 0.0);
+        if (Configuration::getInstance().getInt("bmrm.warmStartPlanes") > 0 && !direct) {
+            warmStarts.resize(nUsers);
+        }
+        {
+            UserPhaseTask task(p, t, lambda, direct, nThreads, losses, warmStarts);
+            cofi::parallel::forEach(task, nUsers, nThreads, 8);
+            statistics = task.getStatistics();
+            if (!direct) {
+                const BundleStatistics& s = statistics;
+                std::clog << "UserTrainer::run: The solver spent " << s.loss << "s in the loss, "
+                        << s.update << "s updating the bundle, " << s.qp << "s in " << s.qpSolves << " QPs ("
+                        << s.pgmIterations << " PGM iterations, " << s.projections << " projection steps), "
+                        << s.solution << "s in the solution, the largest bundle took "
+                        << s.peakBytes / (1024 * 1024) << "MB" << std::endl;
             }
-            lossSum += solver.optimize(iter.getW(), *loss, lambda, t);
+        }
+
+        // Sum up in user order, so the result does not depend on nThreads.
+        Real lossSum = 0.0;
+        for (size_t user = 0; user < nUsers; ++user) {
+            lossSum += losses[user];
 #ifndef NDEBUG
-	    std::clog << "User # : " << iter.getRowInU() << "  Cumulative Loss : " <<  lossSum << std::endl;
+	    std::clog << "User # : " << user << "  Cumulative Loss : " <<  lossSum << std::endl;
 #endif
-            iter.updateW();
-            delete loss;
-        }// while all users
+        }
         if (p.usingMovieOffset()) {
             p.setMovieOffsetColumnInUToOne();
         }
@@ -71,3 +183,9 @@ Real cofi::UserTrainer::run(cofi::Problem& p, size_t t, Real lambda) {
     }// if not using graph kernel
 
 }
+
+
+void cofi::UserTrainer::resetWarmStart(void) {
+    warmStarts.clear();
+    graphKernelWarmStart = BMRMWarmStart();
+}
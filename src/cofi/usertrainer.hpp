@@ -17,14 +17,23 @@
 #ifndef _USERTRAINER_HPP_
 #define _USERTRAINER_HPP_
 
+#include <vector>
 #include "core/types.hpp"
 #include "cofi/problem.hpp"
+#include "bmrm/bmrm.hpp"
 
 
 namespace cofi{
     /**
      * Subspace decent in U.
      *
+     * The per user problems are independent of each other. They are solved
+     * by cofi.threads worker threads which balance the users among themselves
+     * by work stealing. The result does not depend on the number of threads.
+     *
+     * With bmrm.warmStartPlanes, the BMRM state of each user is kept from one
+     * run to the next.
+     *
      */
     class UserTrainer {
         
@@ -37,6 +46,22 @@ namespace cofi{
          */
         Real run(cofi::Problem& p, size_t t, Real lambda);
 
+        /**
+         * @return the statistics of BMRM in the last run.
+         */
+        const BundleStatistics& getStatistics(void) const {
+            return statistics;
+        }
+
+        /**
+         * Forgets the warm start states, e.g. when the users change.
+         */
+        void resetWarmStart(void);
+
+    private:
+        std::vector<BMRMWarmStart> warmStarts;  // Per user
+        BMRMWarmStart graphKernelWarmStart;
+        BundleStatistics statistics;
     };
 }
 #endif
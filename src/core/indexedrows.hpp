@@ -0,0 +1,172 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _INDEXEDROWS_HPP_
+#define _INDEXEDROWS_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "core/reusablearray.hpp"
+
+namespace cofi {
+
+    /**
+     * A read only view on selected rows of a dense, row major matrix.
+     *
+     * Row i of the view is row index(i) of the source matrix. This is used as
+     * X in the per user problems: X consists of the rows of M for the movies
+     * the user has rated. Instead of copying these rows, multiply() and
+     * multiplyTransposed() read them straight from M. The rows of a row major
+     * ublas::matrix are contiguous, so the inner loops run over contiguous
+     * memory.
+     */
+    class IndexedRows {
+    public:
+        typedef boost::numeric::ublas::matrix<double> source_type;
+
+
+        IndexedRows(void) : source(NULL) {
+        }
+
+
+        /**
+         * Sets the matrix to take the rows from.
+         */
+        void setSource(const source_type& m) {
+            source = &m;
+        }
+
+
+        /**
+         * Sets the number of rows in the view. The indices are undefined
+         * afterwards.
+         */
+        void resize(const size_t rows) {
+            indices.resize(rows);
+        }
+
+
+        /**
+         * Makes sure that the view can hold the given number of rows without
+         * allocating memory.
+         */
+        void reserve(const size_t rows) {
+            indices.reserve(rows);
+        }
+
+
+        /**
+         * Makes row i of the view refer to row rowInSource of the source.
+         */
+        void setIndex(const size_t i, const size_t rowInSource) {
+            assert(source != NULL && rowInSource < source->size1());
+            indices[i] = rowInSource;
+        }
+
+
+        /**
+         * @return the number of times memory was allocated for the indices.
+         */
+        size_t allocations(void) const {
+            return indices.allocations();
+        }
+
+
+        size_t index(const size_t i) const {
+            return indices[i];
+        }
+
+
+        size_t size1(void) const {
+            return indices.size();
+        }
+
+
+        size_t size2(void) const {
+            return source == NULL ? 0 : source->size2();
+        }
+
+
+        double operator()(const size_t i, const size_t j) const {
+            return (*source)(indices[i], j);
+        }
+
+
+        /**
+         * @return a pointer to the size2() contiguous entries of row i.
+         */
+        const double* row(const size_t i) const {
+            return &(source->data()[0]) + indices[i] * size2();
+        }
+
+
+        /**
+         * Computes f = X w for a column vector w.
+         *
+         * @param w the vector to multiply with, size2() x 1.
+         * @param f the result. It is resized to size1() x 1.
+         */
+        template<class W, class F> void multiply(const W& w, F& f) const {
+            assert(w.size1() == size2() && w.size2() == 1);
+            const size_t d = size2();
+            if (f.size1() != size1() || f.size2() != 1) {
+                f.resize(size1(), 1, false);
+            }
+            if (d == 0) return;
+            const double* m = &(source->data()[0]);
+            const double* wData = &(w.data()[0]);
+            for (size_t i = 0; i < size1(); ++i) {
+                const double* row = m + indices[i] * d;
+                double sum = 0.0;
+                for (size_t j = 0; j < d; ++j) {
+                    sum += row[j] * wData[j];
+                }
+                f(i, 0) = sum;
+            }
+        }
+
+
+        /**
+         * Computes grad = X' g for a column vector g.
+         *
+         * @param g the vector to multiply with, size1() x 1.
+         * @param grad the result. Its size must be size2() x 1.
+         */
+        template<class G, class W> void multiplyTransposed(const G& g, W& grad) const {
+            assert(g.size1() == size1() && g.size2() == 1);
+            assert(grad.size1() == size2() && grad.size2() == 1);
+            const size_t d = size2();
+            grad.clear();
+            if (d == 0) return;
+            const double* m = &(source->data()[0]);
+            double* gradData = &(grad.data()[0]);
+            for (size_t i = 0; i < size1(); ++i) {
+                const double* row = m + indices[i] * d;
+                const double gi = g(i, 0);
+                for (size_t j = 0; j < d; ++j) {
+                    gradData[j] += gi * row[j];
+                }
+            }
+        }
+
+    private:
+        const source_type* source;
+        ReusableArray<size_t> indices;
+    };
+}
+#endif /* _INDEXEDROWS_HPP_ */
@@ -0,0 +1,126 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "ratingmatrix.hpp"
+#include "core/cofiexception.hpp"
+
+
+namespace {
+
+    /**
+     * @throws CoFiException if one of the nnz columns is not less than cols.
+     */
+    void checkColumns(const size_t nnz, const size_t cols, const size_t* columns) {
+        for (size_t e = 0; e < nnz; ++e) {
+            if (columns[e] >= cols) {
+                throw cofi::CoFiException("cofi::RatingMatrix: Index violation, the matrix has too few columns.");
+            }
+        }
+    }
+
+
+#ifndef NDEBUG
+    void checkRows(const size_t rows, const size_t* rowStart, const size_t* columns) {
+        for (size_t i = 0; i < rows; ++i) {
+            assert(rowStart[i] <= rowStart[i + 1]);
+            for (size_t e = rowStart[i] + 1; e < rowStart[i + 1]; ++e) {
+                assert(columns[e - 1] < columns[e]);
+            }
+        }
+    }
+#else
+    void checkRows(const size_t /* rows */, const size_t* /* rowStart */, const size_t* /* columns */) {
+    }
+#endif
+}
+
+
+cofi::RatingMatrix::~RatingMatrix(void) {
+    delete storage;
+}
+
+
+void cofi::RatingMatrix::release(void) {
+    delete storage;
+    storage = NULL;
+    columnStart.clear();
+    rowData.clear();
+    entryData.clear();
+}
+
+
+void cofi::RatingMatrix::assign(const size_t rows, const size_t cols, const size_t* rowStart, const size_t* columns, const double* values) {
+    const size_t nnz = rowStart[rows];
+    checkColumns(nnz, cols, columns);
+    checkRows(rows, rowStart, columns);
+    release();
+    this->rows = rows;
+    this->cols = cols;
+    this->rowStart.assign(rowStart, rowStart + rows + 1);
+    ownedColumns.assign(columns, columns + nnz);
+    ownedValues.assign(values, values + nnz);
+    columnData = ownedColumns.empty() ? NULL : &ownedColumns[0];
+    valueData = ownedValues.empty() ? NULL : &ownedValues[0];
+}
+
+
+void cofi::RatingMatrix::adopt(const size_t rows, const size_t cols, std::vector<size_t>& rowStart, Storage* storage,
+        const size_t* columns, const double* values) {
+    assert(rowStart.size() == rows + 1);
+    try {
+        checkColumns(rowStart[rows], cols, columns);
+    } catch (...) {
+        delete storage;
+        throw;
+    }
+    checkRows(rows, &rowStart[0], columns);
+    release();
+    this->rows = rows;
+    this->cols = cols;
+    this->rowStart.swap(rowStart);
+    std::vector<size_t>().swap(rowStart);
+    std::vector<size_t>().swap(ownedColumns);
+    std::vector<double>().swap(ownedValues);
+    this->storage = storage;
+    columnData = columns;
+    valueData = values;
+}
+
+
+void cofi::RatingMatrix::buildColumnIndex(void) {
+    if (hasColumnIndex()) return;
+    const size_t nnz = this->nnz();
+
+    // Count the entries per column, then place them row by row, which keeps
+    // the rows increasing within a column
+    columnStart.assign(cols + 1, 0);
+    for (size_t e = 0; e < nnz; ++e) {
+        columnStart[columnData[e] + 1] += 1;
+    }
+    for (size_t j = 0; j < cols; ++j) {
+        columnStart[j + 1] += columnStart[j];
+    }
+    rowData.resize(nnz);
+    entryData.resize(nnz);
+    std::vector<size_t> next(columnStart.begin(), columnStart.end() - 1);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t e = rowStart[i]; e < rowStart[i + 1]; ++e) {
+            const size_t c = next[columnData[e]]++;
+            rowData[c] = i;
+            entryData[c] = e;
+        }
+    }
+}
@@ -0,0 +1,230 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _RATINGMATRIX_HPP_
+#define _RATINGMATRIX_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace cofi {
+
+    /**
+     * A sparse matrix of ratings in compressed row (CSR) form.
+     *
+     * The entries are numbered in row major order: the entries of row i are
+     * e = rowBegin(i) ... rowEnd(i)-1, with the increasing columns column(e)
+     * and the values value(e). All three arrays are contiguous.
+     *
+     * The column and value arrays are either owned by the matrix or external
+     * and kept alive by a Storage, such as a mapped file, see adopt().
+     *
+     * The matrix does not change once assigned. Optionally, it keeps a
+     * compressed column (CSC) index as well, see buildColumnIndex(): the
+     * entries of column j in the order of increasing rows are
+     * entry(c) for c = columnBegin(j) ... columnEnd(j)-1.
+     */
+    class RatingMatrix {
+    public:
+
+        /**
+         * Owns the external arrays of a matrix, see adopt().
+         */
+        class Storage {
+        public:
+
+
+            virtual ~Storage(void) {
+            }
+        };
+
+
+        RatingMatrix(void) : rows(0), cols(0), rowStart(1, 0), columnData(NULL), valueData(NULL), storage(NULL) {
+        }
+
+
+        /**
+         * Creates an empty matrix of the given size.
+         */
+        RatingMatrix(const size_t rows, const size_t cols) : rows(rows), cols(cols), rowStart(rows + 1, 0),
+        columnData(NULL), valueData(NULL), storage(NULL) {
+        }
+
+
+        /**
+         * Deletes the storage, if any.
+         */
+        ~RatingMatrix(void);
+
+
+        /**
+         * Replaces the contents. The column index is dropped.
+         *
+         * @param rows the number of rows.
+         * @param cols the number of columns.
+         * @param rowStart the rows+1 start positions of the rows.
+         * @param columns the columns of the rowStart[rows] entries, strictly
+         *        increasing within a row.
+         * @param values the values of the entries.
+         * @throws CoFiException if a column is not less than cols.
+         */
+        void assign(const size_t rows, const size_t cols, const size_t* rowStart, const size_t* columns, const double* values);
+
+
+        /**
+         * Replaces the contents without copying the entries. The column
+         * index is dropped.
+         *
+         * @param rows the number of rows.
+         * @param cols the number of columns.
+         * @param rowStart the rows+1 start positions of the rows. Taken over,
+         *        it is empty afterwards.
+         * @param storage owns columns and values and is deleted with the
+         *        matrix. The matrix takes ownership.
+         * @param columns the columns of the entries, as for assign().
+         * @param values the values of the entries.
+         * @throws CoFiException if a column is not less than cols. The
+         *         storage is deleted in this case.
+         */
+        void adopt(const size_t rows, const size_t cols, std::vector<size_t>& rowStart, Storage* storage,
+                const size_t* columns, const double* values);
+
+
+        /**
+         * Builds the column index, unless it is there already. This is the
+         * only modification and must not run concurrently with any other
+         * access.
+         */
+        void buildColumnIndex(void);
+
+
+        size_t size1(void) const {
+            return rows;
+        }
+
+
+        size_t size2(void) const {
+            return cols;
+        }
+
+
+        /**
+         * @return the number of stored entries.
+         */
+        size_t nnz(void) const {
+            return rowStart[rows];
+        }
+
+
+        size_t rowBegin(const size_t i) const {
+            assert(i < rows);
+            return rowStart[i];
+        }
+
+
+        size_t rowEnd(const size_t i) const {
+            assert(i < rows);
+            return rowStart[i + 1];
+        }
+
+
+        /**
+         * @return the number of entries in row i.
+         */
+        size_t rowSize(const size_t i) const {
+            return rowEnd(i) - rowBegin(i);
+        }
+
+
+        size_t column(const size_t e) const {
+            return columnData[e];
+        }
+
+
+        double value(const size_t e) const {
+            return valueData[e];
+        }
+
+
+        /**
+         * @return true, if buildColumnIndex() was called since the last
+         *         assign().
+         */
+        bool hasColumnIndex(void) const {
+            return columnStart.size() == cols + 1;
+        }
+
+
+        size_t columnBegin(const size_t j) const {
+            assert(hasColumnIndex() && j < cols);
+            return columnStart[j];
+        }
+
+
+        size_t columnEnd(const size_t j) const {
+            assert(hasColumnIndex() && j < cols);
+            return columnStart[j + 1];
+        }
+
+
+        /**
+         * @return the row of the c-th entry in column order.
+         */
+        size_t row(const size_t c) const {
+            return rowData[c];
+        }
+
+
+        /**
+         * @return the number in row major order of the c-th entry in column
+         *         order, i.e. its position in the arrays of column() and
+         *         value().
+         */
+        size_t entry(const size_t c) const {
+            return entryData[c];
+        }
+
+    private:
+        // Not implemented, the storage is owned.
+        RatingMatrix(const RatingMatrix& other);
+        RatingMatrix& operator=(const RatingMatrix& other);
+
+        /**
+         * Deletes the storage and the column index.
+         */
+        void release(void);
+
+        size_t rows;
+        size_t cols;
+
+        // The compressed rows
+        std::vector<size_t> rowStart;
+        const size_t* columnData;
+        const double* valueData;
+
+        // The entries, unless they are external
+        std::vector<size_t> ownedColumns;
+        std::vector<double> ownedValues;
+        Storage* storage;
+
+        // The column index, empty until built
+        std::vector<size_t> columnStart;
+        std::vector<size_t> rowData;
+        std::vector<size_t> entryData;
+    };
+}
+#endif /* _RATINGMATRIX_HPP_ */
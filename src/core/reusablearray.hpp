@@ -0,0 +1,227 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _REUSABLEARRAY_HPP_
+#define _REUSABLEARRAY_HPP_
+
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+namespace cofi {
+
+    /**
+     * A storage array for ublas::matrix which keeps its capacity.
+     *
+     * ublas::unbounded_array reallocates whenever its size changes. This
+     * array only does so if the new size exceeds its capacity. This makes it
+     * a good fit for workspaces that are refilled with differently sized data
+     * over and over again, like the per user problems in the UserIterator.
+     *
+     * Use it as ublas::matrix<Real, ublas::row_major, ReusableArray<Real> >.
+     */
+    template<class T> class ReusableArray {
+    public:
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T value_type;
+        typedef const T& const_reference;
+        typedef T& reference;
+        typedef const T* const_pointer;
+        typedef T* pointer;
+        typedef const_pointer const_iterator;
+        typedef pointer iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+
+
+        ReusableArray(void) : size_(0), capacity_(0), data_(NULL), allocations_(0) {
+        }
+
+
+        explicit ReusableArray(const size_type size) : size_(0), capacity_(0), data_(NULL), allocations_(0) {
+            resize(size);
+        }
+
+
+        ReusableArray(const size_type size, const value_type& init) : size_(0), capacity_(0), data_(NULL), allocations_(0) {
+            resize(size, init);
+        }
+
+
+        ReusableArray(const ReusableArray& a) : size_(0), capacity_(0), data_(NULL), allocations_(0) {
+            resize(a.size_);
+            std::copy(a.begin(), a.end(), begin());
+        }
+
+
+        ~ReusableArray(void) {
+            delete[] data_;
+        }
+
+
+        ReusableArray& operator=(const ReusableArray& a) {
+            if (this != &a) {
+                resize(a.size_);
+                std::copy(a.begin(), a.end(), begin());
+            }
+            return *this;
+        }
+
+
+        /**
+         * Changes the size. The content is undefined afterwards.
+         */
+        void resize(const size_type size) {
+            reserve(size);
+            size_ = size;
+        }
+
+
+        /**
+         * Changes the size, keeping the content. New elements are set to init.
+         */
+        void resize(const size_type size, const value_type& init) {
+            if (size > capacity_) {
+                T* newData = new T[size];
+                ++allocations_;
+                std::copy(data_, data_ + size_, newData);
+                delete[] data_;
+                data_ = newData;
+                capacity_ = size;
+            }
+            if (size > size_) {
+                std::fill(data_ + size_, data_ + size, init);
+            }
+            size_ = size;
+        }
+
+
+        /**
+         * Makes sure that the array can hold capacity elements without
+         * reallocation. The content is undefined afterwards if this results in
+         * a reallocation.
+         */
+        void reserve(const size_type capacity) {
+            if (capacity > capacity_) {
+                delete[] data_;
+                data_ = NULL;
+                data_ = new T[capacity];
+                ++allocations_;
+                capacity_ = capacity;
+            }
+        }
+
+
+        void swap(ReusableArray& a) {
+            if (this != &a) {
+                std::swap(size_, a.size_);
+                std::swap(capacity_, a.capacity_);
+                std::swap(data_, a.data_);
+            }
+        }
+
+
+        friend void swap(ReusableArray& a1, ReusableArray& a2) {
+            a1.swap(a2);
+        }
+
+
+        size_type size(void) const {
+            return size_;
+        }
+
+
+        size_type max_size(void) const {
+            return size_type(-1) / sizeof (T);
+        }
+
+
+        bool empty(void) const {
+            return size_ == 0;
+        }
+
+
+        size_type capacity(void) const {
+            return capacity_;
+        }
+
+
+        /**
+         * @return the number of times memory was allocated by this array.
+         */
+        size_type allocations(void) const {
+            return allocations_;
+        }
+
+
+        const_reference operator[](const size_type i) const {
+            return data_[i];
+        }
+
+
+        reference operator[](const size_type i) {
+            return data_[i];
+        }
+
+
+        const_iterator begin(void) const {
+            return data_;
+        }
+
+
+        const_iterator end(void) const {
+            return data_ + size_;
+        }
+
+
+        iterator begin(void) {
+            return data_;
+        }
+
+
+        iterator end(void) {
+            return data_ + size_;
+        }
+
+
+        const_reverse_iterator rbegin(void) const {
+            return const_reverse_iterator(end());
+        }
+
+
+        const_reverse_iterator rend(void) const {
+            return const_reverse_iterator(begin());
+        }
+
+
+        reverse_iterator rbegin(void) {
+            return reverse_iterator(end());
+        }
+
+
+        reverse_iterator rend(void) {
+            return reverse_iterator(begin());
+        }
+
+    private:
+        size_type size_;
+        size_type capacity_;
+        T* data_;
+        size_type allocations_;
+    };
+}
+#endif /* _REUSABLEARRAY_HPP_ */
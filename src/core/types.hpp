@@ -25,6 +25,10 @@
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 
+#include "core/reusablearray.hpp"
+#include "core/indexedrows.hpp"
+#include "core/ratingmatrix.hpp"
+
 
 
 namespace ublas = boost::numeric::ublas;
@@ -38,7 +42,7 @@ namespace cofi {
     typedef Real EntryType;
 
     // Types for the input data
-    typedef ublas::compressed_matrix<cofi::EntryType> DType;
+    typedef cofi::RatingMatrix DType;
     typedef ublas::compressed_matrix<Real> SType;
 
     typedef ublas::matrix<Real> FType;
@@ -48,9 +52,11 @@ namespace cofi {
     typedef ublas::matrix<Real> MType;
     typedef ublas::matrix<Real> UType;
 
-    // The types for the small optimization problems
-    typedef ublas::matrix<Real> XType;
-    typedef ublas::matrix<Real> YType;
+    // The types for the small optimization problems. X and Y are refilled
+    // for every user, so their storage keeps its capacity. X is a view on the
+    // rows of M the user has rated.
+    typedef cofi::IndexedRows XType;
+    typedef ublas::matrix<Real, ublas::row_major, cofi::ReusableArray<Real> > YType;
     typedef ublas::matrix<Real> WType;
 
 
@@ -0,0 +1,97 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "bufferedwriter.hpp"
+
+#include <unistd.h>
+#include <sstream>
+
+#include "core/cofiexception.hpp"
+#include "utils/utils.hpp"
+
+
+cofi::io::BufferedWriter::BufferedWriter(const std::string& filename, const size_t bufferSize) :
+name(filename), tmpName(filename + ".tmp." + to_string(getpid())), file(NULL), buffer(bufferSize < 64 ? 64 : bufferSize), used(0) {
+    file = fopen(tmpName.c_str(), "wb");
+    if (file == NULL) {
+        throw CoFiException("Unable to create file: " + tmpName);
+    }
+}
+
+
+cofi::io::BufferedWriter::~BufferedWriter(void) {
+    if (file != NULL) {
+        fclose(file);
+        unlink(tmpName.c_str());
+    }
+}
+
+
+void cofi::io::BufferedWriter::writeIndex(size_t i) {
+    char digits[24];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char> ('0' + i % 10);
+        i /= 10;
+    } while (i > 0);
+    if (used + n > buffer.size()) {
+        flush();
+    }
+    while (n > 0) {
+        buffer[used++] = digits[--n];
+    }
+}
+
+
+void cofi::io::BufferedWriter::writeReal(const double r) {
+    char text[32];
+    const int n = snprintf(text, sizeof (text), "%.17g", r);
+    write(text, static_cast<size_t> (n));
+}
+
+
+void cofi::io::BufferedWriter::close(void) {
+    flush();
+    const int status = fclose(file);
+    file = NULL;
+    if (status != 0 || rename(tmpName.c_str(), name.c_str()) != 0) {
+        unlink(tmpName.c_str());
+        throw CoFiException("Unable to write file: " + name);
+    }
+}
+
+
+void cofi::io::BufferedWriter::flush(void) {
+    if (used > 0) {
+        writeThrough(&buffer[0], used);
+        used = 0;
+    }
+}
+
+
+void cofi::io::BufferedWriter::writeThrough(const void* data, const size_t bytes) {
+    if (fwrite(data, 1, bytes, file) != bytes) {
+        fail();
+    }
+}
+
+
+void cofi::io::BufferedWriter::fail(void) {
+    fclose(file);
+    file = NULL;
+    unlink(tmpName.c_str());
+    throw CoFiException("Unable to write file: " + name);
+}
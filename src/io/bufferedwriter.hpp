@@ -0,0 +1,116 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _BUFFEREDWRITER_HPP_
+#define _BUFFEREDWRITER_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+namespace cofi {
+    namespace io {
+
+        /**
+         * Writes a file through a large buffer.
+         *
+         * The file is first written under a temporary name and renamed by
+         * close(), so readers never see a partial file. If the writer is
+         * destroyed without close(), the temporary file is removed.
+         */
+        class BufferedWriter {
+        public:
+            /**
+             * Creates the file.
+             *
+             * @throws CoFiException if the file cannot be created.
+             */
+            BufferedWriter(const std::string& filename, const size_t bufferSize = 1 << 20);
+
+            ~BufferedWriter(void);
+
+
+            /**
+             * Appends the given bytes.
+             *
+             * @throws CoFiException if the data cannot be written.
+             */
+            void write(const void* data, const size_t bytes) {
+                if (used + bytes > buffer.size()) {
+                    flush();
+                    if (bytes > buffer.size()) {
+                        writeThrough(data, bytes);
+                        return;
+                    }
+                }
+                memcpy(&buffer[used], data, bytes);
+                used += bytes;
+            }
+
+
+            void write(const std::string& s) {
+                write(s.data(), s.size());
+            }
+
+
+            void write(const char c) {
+                if (used == buffer.size()) {
+                    flush();
+                }
+                buffer[used++] = c;
+            }
+
+
+            /**
+             * Appends the decimal form of the given index.
+             */
+            void writeIndex(size_t i);
+
+
+            /**
+             * Appends the given value in %.17g form, which reads back exactly.
+             */
+            void writeReal(const double r);
+
+
+            /**
+             * Writes the buffer to the file and renames it to its final name.
+             *
+             * @throws CoFiException if the file cannot be written.
+             */
+            void close(void);
+
+        private:
+            // Not implemented, the file is owned.
+            BufferedWriter(const BufferedWriter& other);
+            BufferedWriter& operator=(const BufferedWriter& other);
+
+            void flush(void);
+
+            void writeThrough(const void* data, const size_t bytes);
+
+            void fail(void);
+
+            std::string name;
+            std::string tmpName;
+            FILE* file;
+            std::vector<char> buffer;
+            size_t used;
+        };
+    }
+}
+#endif /* _BUFFEREDWRITER_HPP_ */
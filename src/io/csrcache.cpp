@@ -0,0 +1,199 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "csrcache.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "io/mappedfile.hpp"
+#include "core/cofiexception.hpp"
+#include "utils/utils.hpp"
+
+namespace {
+
+    const char MAGIC[8] = {'C', 'O', 'F', 'I', 'C', 'S', 'R', '\0'};
+
+    // Increment whenever the layout changes
+    const uint32_t VERSION = 1;
+
+    // Written as is, reads back differently on a machine of other endianess
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t indexSize; // sizeof(size_t)
+        uint32_t valueSize; // sizeof(Real)
+        uint64_t sourceSize;
+        int64_t sourceMTime;
+        int64_t sourceMTimeNSec;
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t nnz;
+    };
+
+
+    /**
+     * Fills in the header fields describing this build and the source file.
+     *
+     * @return false, if the source file does not exist.
+     */
+    bool describe(const std::string& sourceFile, Header& h) {
+        struct stat info;
+        if (stat(sourceFile.c_str(), &info) != 0) {
+            return false;
+        }
+        memset(&h, 0, sizeof (h));
+        memcpy(h.magic, MAGIC, sizeof (MAGIC));
+        h.version = VERSION;
+        h.byteOrder = BYTE_ORDER_MARK;
+        h.indexSize = sizeof (size_t);
+        h.valueSize = sizeof (Real);
+        h.sourceSize = static_cast<uint64_t> (info.st_size);
+#ifdef __APPLE__
+        h.sourceMTime = static_cast<int64_t> (info.st_mtimespec.tv_sec);
+        h.sourceMTimeNSec = static_cast<int64_t> (info.st_mtimespec.tv_nsec);
+#else
+        h.sourceMTime = static_cast<int64_t> (info.st_mtim.tv_sec);
+        h.sourceMTimeNSec = static_cast<int64_t> (info.st_mtim.tv_nsec);
+#endif
+        return true;
+    }
+
+
+    size_t align(const size_t offset) {
+        return (offset + 7) & ~static_cast<size_t> (7);
+    }
+
+
+    void write(FILE* f, const void* data, const size_t bytes, const std::string& name) {
+        if (bytes > 0 && fwrite(data, 1, bytes, f) != bytes) {
+            fclose(f);
+            unlink(name.c_str());
+            throw cofi::CoFiException("Unable to write the CSR cache file " + name);
+        }
+    }
+}
+
+
+std::string cofi::io::csrcache::cacheFileName(const std::string& sourceFile) {
+    return sourceFile + ".csr";
+}
+
+
+bool cofi::io::csrcache::load(const std::string& sourceFile, CSRData& data) {
+    Header expected;
+    if (!describe(sourceFile, expected)) {
+        return false;
+    }
+    const std::string name = cacheFileName(sourceFile);
+    if (access(name.c_str(), R_OK) != 0) {
+        return false;
+    }
+
+    MappedFile* file = new MappedFile(name);
+    if (file->size() < sizeof (Header)) {
+        delete file;
+        return false;
+    }
+    Header h;
+    memcpy(&h, file->data(), sizeof (Header));
+    const bool valid = memcmp(h.magic, expected.magic, sizeof (h.magic)) == 0
+            && h.version == expected.version
+            && h.byteOrder == expected.byteOrder
+            && h.indexSize == expected.indexSize
+            && h.valueSize == expected.valueSize
+            && h.sourceSize == expected.sourceSize
+            && h.sourceMTime == expected.sourceMTime
+            && h.sourceMTimeNSec == expected.sourceMTimeNSec;
+
+    const size_t rowStartOffset = align(sizeof (Header));
+    const size_t columnOffset = align(rowStartOffset + (h.rows + 1) * sizeof (size_t));
+    const size_t valueOffset = align(columnOffset + h.nnz * sizeof (size_t));
+    const size_t end = valueOffset + h.nnz * sizeof (Real);
+    if (!valid || file->size() != end) {
+        delete file;
+        return false;
+    }
+
+    const char* base = file->data();
+    const size_t* rowStart = reinterpret_cast<const size_t*> (base + rowStartOffset);
+    if (rowStart[0] != 0 || rowStart[h.rows] != h.nnz) {
+        delete file;
+        return false;
+    }
+    data.adopt(file, h.rows, h.cols, h.nnz, rowStart,
+            reinterpret_cast<const size_t*> (base + columnOffset),
+            reinterpret_cast<const Real*> (base + valueOffset));
+    return true;
+}
+
+
+void cofi::io::csrcache::store(const std::string& sourceFile, const CSRData& data) {
+    Header h;
+    if (!describe(sourceFile, h)) {
+        throw CoFiException("Unable to stat " + sourceFile);
+    }
+    h.rows = data.size1();
+    h.cols = data.size2();
+    h.nnz = data.nnz();
+
+    const std::string name = cacheFileName(sourceFile);
+    const std::string tmpName = name + ".tmp." + to_string(getpid());
+    FILE* f = fopen(tmpName.c_str(), "wb");
+    if (f == NULL) {
+        throw CoFiException("Unable to create the CSR cache file " + tmpName);
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t offset = 0;
+    write(f, &h, sizeof (h), tmpName);
+    offset += sizeof (h);
+    write(f, padding, align(offset) - offset, tmpName);
+    offset = align(offset);
+    write(f, data.rowStart(), (data.size1() + 1) * sizeof (size_t), tmpName);
+    offset += (data.size1() + 1) * sizeof (size_t);
+    write(f, padding, align(offset) - offset, tmpName);
+    offset = align(offset);
+    write(f, data.columns(), data.nnz() * sizeof (size_t), tmpName);
+    offset += data.nnz() * sizeof (size_t);
+    write(f, padding, align(offset) - offset, tmpName);
+    write(f, data.values(), data.nnz() * sizeof (Real), tmpName);
+    if (fclose(f) != 0 || rename(tmpName.c_str(), name.c_str()) != 0) {
+        unlink(tmpName.c_str());
+        throw CoFiException("Unable to write the CSR cache file " + name);
+    }
+}
+
+
+void cofi::io::loadSVMLightCached(const std::string& filename, CSRData& data, const size_t nThreads) {
+    if (csrcache::load(filename, data)) {
+        std::clog << "cofi::io::loadSVMLightCached: Using the cache " << csrcache::cacheFileName(filename) << std::endl;
+        return;
+    }
+    loadSVMLight(filename, data, nThreads);
+    try {
+        csrcache::store(filename, data);
+        std::clog << "cofi::io::loadSVMLightCached: Wrote the cache " << csrcache::cacheFileName(filename) << std::endl;
+    } catch (CoFiException& e) {
+        std::clog << "cofi::io::loadSVMLightCached: " << e.describe() << std::endl;
+    }
+}
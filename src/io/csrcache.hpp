@@ -0,0 +1,77 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _CSRCACHE_HPP_
+#define _CSRCACHE_HPP_
+
+#include <string>
+
+#include "io/svmlightloader.hpp"
+
+namespace cofi {
+    namespace io {
+
+        /**
+         * A binary cache of the CSR form of an SVMLight file.
+         *
+         * The file consists of a fixed size header followed by the arrays
+         * rowStart (rows+1 entries), columns and values (nnz entries each),
+         * stored in native byte order. Each array starts at a multiple of 8
+         * bytes, so the file can be mapped and used in place.
+         *
+         * The header records the size and modification time of the SVMLight
+         * file the cache was built from. A cache whose header does not match
+         * the current source file, or this build's format, is stale.
+         */
+        namespace csrcache {
+
+            /**
+             * @return the name of the cache file for the given SVMLight file.
+             */
+            std::string cacheFileName(const std::string& sourceFile);
+
+
+            /**
+             * Maps the cache of the given SVMLight file into data.
+             *
+             * @return false, if there is no valid cache for the file.
+             */
+            bool load(const std::string& sourceFile, CSRData& data);
+
+
+            /**
+             * Writes the cache for the given SVMLight file.
+             *
+             * The cache is written to a temporary file first and then renamed,
+             * so readers never see a partial cache.
+             *
+             * @throws CoFiException if the cache cannot be written.
+             */
+            void store(const std::string& sourceFile, const CSRData& data);
+        }
+
+
+        /**
+         * Loads an SVMLight file, using and maintaining its binary cache.
+         *
+         * If the cache is valid, it is mapped. Otherwise, the SVMLight file is
+         * parsed with loadSVMLight() and the cache is rebuilt. Failure to
+         * write the cache is reported to std::clog, but not fatal.
+         */
+        void loadSVMLightCached(const std::string& filename, CSRData& data, const size_t nThreads);
+    }
+}
+#endif /* _CSRCACHE_HPP_ */
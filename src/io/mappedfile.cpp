@@ -0,0 +1,56 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "mappedfile.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "core/cofiexception.hpp"
+
+
+cofi::io::MappedFile::MappedFile(const std::string& filename) : bytes(NULL), length(0) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw CoFiException("Unable to open file: " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw CoFiException("Unable to determine the size of file: " + filename);
+    }
+    length = static_cast<size_t> (info.st_size);
+    if (length > 0) {
+        void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw CoFiException("Unable to map file: " + filename);
+        }
+        // We read the file front to back
+        madvise(p, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*> (p);
+    }
+    close(fd);
+}
+
+
+cofi::io::MappedFile::~MappedFile(void) {
+    if (bytes != NULL) {
+        munmap(const_cast<char*> (bytes), length);
+    }
+}
@@ -0,0 +1,68 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _MAPPEDFILE_HPP_
+#define _MAPPEDFILE_HPP_
+
+#include <string>
+#include <cstddef>
+
+namespace cofi {
+    namespace io {
+
+        /**
+         * A file mapped read only into memory.
+         *
+         * The mapping lives as long as this object.
+         */
+        class MappedFile {
+        public:
+            /**
+             * Maps the given file.
+             *
+             * @throws CoFiException if the file cannot be opened or mapped.
+             */
+            MappedFile(const std::string& filename);
+
+            ~MappedFile(void);
+
+
+            /**
+             * @return the contents of the file. NULL for empty files.
+             */
+            const char* data(void) const {
+                return bytes;
+            }
+
+
+            /**
+             * @return the size of the file in bytes.
+             */
+            size_t size(void) const {
+                return length;
+            }
+
+        private:
+            // Not implemented, the mapping is owned.
+            MappedFile(const MappedFile& other);
+            MappedFile& operator=(const MappedFile& other);
+
+            const char* bytes;
+            size_t length;
+        };
+    }
+}
+#endif /* _MAPPEDFILE_HPP_ */
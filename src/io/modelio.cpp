@@ -0,0 +1,155 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "modelio.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+
+#include "io/mappedfile.hpp"
+#include "core/cofiexception.hpp"
+
+namespace {
+
+    const char MAGIC[8] = {'C', 'O', 'F', 'I', 'M', 'D', 'L', '\0'};
+
+    // Increment whenever the layout changes
+    const uint32_t VERSION = 1;
+
+    // Written as is, reads back differently on a machine of other endianess
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t valueSize; // sizeof(float) or sizeof(double)
+        uint32_t reserved;
+    };
+
+    struct RecordHeader {
+        char name[8];
+        uint64_t rows;
+        uint64_t cols;
+    };
+
+
+    size_t align(const size_t offset) {
+        return (offset + 7) & ~static_cast<size_t> (7);
+    }
+}
+
+
+cofi::io::ModelWriter::ModelWriter(const std::string& filename, const bool singlePrecision) :
+out(filename), singlePrecision(singlePrecision) {
+    FileHeader h;
+    memset(&h, 0, sizeof (h));
+    memcpy(h.magic, MAGIC, sizeof (MAGIC));
+    h.version = VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    h.valueSize = singlePrecision ? sizeof (float) : sizeof (double);
+    out.write(&h, sizeof (h));
+}
+
+
+void cofi::io::ModelWriter::add(const std::string& name, const ublas::matrix<Real>& m) {
+    if (name.size() > sizeof (RecordHeader().name)) {
+        throw CoFiException("Matrix name too long for the model file: " + name);
+    }
+    RecordHeader r;
+    memset(&r, 0, sizeof (r));
+    memcpy(r.name, name.data(), name.size());
+    r.rows = m.size1();
+    r.cols = m.size2();
+    out.write(&r, sizeof (r));
+
+    const size_t n = m.size1() * m.size2();
+    if (n == 0) {
+        return;
+    }
+    const Real* data = &m.data()[0];
+    if (!singlePrecision) {
+        out.write(data, n * sizeof (double));
+        return;
+    }
+    rowBuffer.resize(m.size2());
+    for (size_t row = 0; row < m.size1(); ++row) {
+        for (size_t col = 0; col < m.size2(); ++col) {
+            rowBuffer[col] = static_cast<float> (data[row * m.size2() + col]);
+        }
+        out.write(&rowBuffer[0], m.size2() * sizeof (float));
+    }
+    const size_t bytes = n * sizeof (float);
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    out.write(padding, align(bytes) - bytes);
+}
+
+
+void cofi::io::ModelWriter::close(void) {
+    out.close();
+}
+
+
+bool cofi::io::loadModelMatrix(const std::string& filename, const std::string& name, ublas::matrix<Real>& m) {
+    MappedFile file(filename);
+    FileHeader h;
+    if (file.size() < sizeof (h)) {
+        throw CoFiException("Not a model file: " + filename);
+    }
+    memcpy(&h, file.data(), sizeof (h));
+    if (memcmp(h.magic, MAGIC, sizeof (MAGIC)) != 0 || h.version != VERSION
+            || h.byteOrder != BYTE_ORDER_MARK
+            || (h.valueSize != sizeof (float) && h.valueSize != sizeof (double))) {
+        throw CoFiException("Not a model file of this version and platform: " + filename);
+    }
+
+    size_t offset = sizeof (h);
+    while (offset < file.size()) {
+        RecordHeader r;
+        if (file.size() - offset < sizeof (r)) {
+            throw CoFiException("Truncated model file: " + filename);
+        }
+        memcpy(&r, file.data() + offset, sizeof (r));
+        offset += sizeof (r);
+        const uint64_t n = r.rows * r.cols;
+        if (r.cols != 0 && n / r.cols != r.rows) {
+            throw CoFiException("Corrupt model file: " + filename);
+        }
+        // Checked before multiplying, which could overflow otherwise
+        if (n > (file.size() - offset) / h.valueSize) {
+            throw CoFiException("Truncated model file: " + filename);
+        }
+        const size_t bytes = align(static_cast<size_t> (n) * h.valueSize);
+        if (bytes > file.size() - offset) {
+            throw CoFiException("Truncated model file: " + filename);
+        }
+        if (name.size() <= sizeof (r.name) && memcmp(r.name, name.data(), name.size()) == 0
+                && (name.size() == sizeof (r.name) || r.name[name.size()] == '\0')) {
+            m.resize(r.rows, r.cols, false);
+            if (n > 0 && h.valueSize == sizeof (double)) {
+                memcpy(&m.data()[0], file.data() + offset, n * sizeof (double));
+            } else if (n > 0) {
+                const float* values = reinterpret_cast<const float*> (file.data() + offset);
+                std::copy(values, values + n, m.data().begin());
+            }
+            return true;
+        }
+        offset += bytes;
+    }
+    return false;
+}
+
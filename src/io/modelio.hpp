@@ -0,0 +1,78 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _MODELIO_HPP_
+#define _MODELIO_HPP_
+
+#include <string>
+#include <vector>
+
+#include "core/types.hpp"
+#include "io/bufferedwriter.hpp"
+
+namespace cofi {
+    namespace io {
+
+        /**
+         * Writes a binary model file.
+         *
+         * A model file is a header followed by a sequence of named dense
+         * matrices. Each matrix is stored as a record header (name, rows,
+         * columns) and its entries in row major order, either as double or
+         * as float, in native byte order. Every record starts at a multiple
+         * of 8 bytes.
+         */
+        class ModelWriter {
+        public:
+            /**
+             * @param filename the file to write.
+             * @param singlePrecision whether to store the entries as float.
+             * @throws CoFiException if the file cannot be created.
+             */
+            ModelWriter(const std::string& filename, const bool singlePrecision);
+
+
+            /**
+             * Appends the given matrix. Names are at most 8 characters.
+             */
+            void add(const std::string& name, const ublas::matrix<Real>& m);
+
+
+            /**
+             * Finishes the file.
+             *
+             * @throws CoFiException if the file cannot be written.
+             */
+            void close(void);
+
+        private:
+            BufferedWriter out;
+            bool singlePrecision;
+            std::vector<float> rowBuffer;
+        };
+
+
+        /**
+         * Loads the matrix with the given name from a model file written by
+         * ModelWriter.
+         *
+         * @return false, if the model does not contain such a matrix.
+         * @throws CoFiException if the file is not a valid model file.
+         */
+        bool loadModelMatrix(const std::string& filename, const std::string& name, ublas::matrix<Real>& m);
+    }
+}
+#endif /* _MODELIO_HPP_ */
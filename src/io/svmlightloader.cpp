@@ -0,0 +1,437 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "svmlightloader.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+
+#include "io/mappedfile.hpp"
+#include "core/cofiexception.hpp"
+#include "utils/parallel.hpp"
+
+namespace {
+
+    // Files smaller than this are parsed in one chunk
+    const size_t MIN_PARALLEL_SIZE = 1 << 20;
+
+    // Exactly representable powers of ten
+    const double POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+
+    inline bool isSpace(const char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == '\n';
+    }
+
+
+    inline bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+
+
+    /**
+     * Parses the value of a token, as sscanf("%lf") would.
+     *
+     * Plain decimals with at most 15 significant digits are converted
+     * directly. The result is correctly rounded, as both the mantissa and the
+     * power of ten are exact doubles. Everything else is left to strtod().
+     */
+    Real parseValue(const char* s, const char* e) {
+        const char* q = s;
+        bool negative = false;
+        if (q < e && (*q == '-' || *q == '+')) {
+            negative = (*q == '-');
+            ++q;
+        }
+        unsigned long long mantissa = 0;
+        size_t digits = 0; // significant digits
+        size_t decimals = 0;
+        bool any = false;
+        for (; q < e && isDigit(*q) && digits <= 15; ++q) {
+            mantissa = mantissa * 10 + (*q - '0');
+            if (mantissa != 0) ++digits;
+            any = true;
+        }
+        if (q < e && *q == '.') {
+            ++q;
+            for (; q < e && isDigit(*q) && digits <= 15; ++q) {
+                mantissa = mantissa * 10 + (*q - '0');
+                if (mantissa != 0) ++digits;
+                ++decimals;
+                any = true;
+            }
+        }
+        if (any && q == e && digits <= 15 && decimals <= 22) {
+            const Real value = static_cast<Real> (mantissa) / POWERS_OF_TEN[decimals];
+            return negative ? -value : value;
+        }
+
+        const std::string token(s, e);
+        char* end = NULL;
+        const Real value = strtod(token.c_str(), &end);
+        return (end == token.c_str()) ? 0.0 : value;
+    }
+
+
+    /**
+     * Parses a column:value token, as sscanf("%d:%lf") would.
+     *
+     * @param column the zero based column.
+     */
+    void parseToken(const char* t, const char* e, size_t& column, Real& value) {
+        const char* q = t;
+        bool negative = false;
+        if (q < e && (*q == '-' || *q == '+')) {
+            negative = (*q == '-');
+            ++q;
+        }
+        size_t c = 0;
+        bool any = false;
+        for (; q < e && isDigit(*q); ++q) {
+            c = c * 10 + (*q - '0');
+            any = true;
+        }
+        if (!any || (negative && c > 0)) {
+            throw cofi::CoFiException("Found a column index which is less than zero.");
+        }
+        if (c == 0) {
+            throw cofi::CoFiException("Found a column index of zero, the columns start at 1.");
+        }
+        column = c - 1;
+        value = (q < e && *q == ':') ? parseValue(q + 1, e) : 0.0;
+    }
+
+
+    /**
+     * The result of parsing one chunk of the file.
+     */
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<size_t> lineNnz; // number of entries per line
+        std::vector<size_t> columns;
+        std::vector<Real> values;
+        bool counted; // Whether a line counts as a row, see below
+        size_t lastCounted; // The last line that does
+        size_t maxColumn;
+    };
+
+
+    /**
+     * Sorts the entries of a line by column. Of duplicate columns, the last
+     * entry is kept, as the last assignment to the matrix would.
+     */
+    void sortLine(Chunk& c, const size_t first) {
+        const size_t n = c.columns.size() - first;
+        std::vector<std::pair<size_t, size_t> > order(n);
+        for (size_t i = 0; i < n; ++i) {
+            order[i] = std::make_pair(c.columns[first + i], i);
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<Real> values(n);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = c.values[first + i];
+        }
+        size_t out = first;
+        for (size_t i = 0; i < n; ++i) {
+            if (i + 1 < n && order[i + 1].first == order[i].first) {
+                continue;
+            }
+            c.columns[out] = order[i].first;
+            c.values[out] = values[order[i].second];
+            ++out;
+        }
+        c.columns.resize(out);
+        c.values.resize(out);
+    }
+
+
+    /**
+     * Parses the lines of a chunk.
+     *
+     * A line counts as a row of the matrix if it has entries or if it is
+     * empty and terminated by a newline. This matches what SVMLightReader
+     * reports to its IndexValueHandler.
+     */
+    void parseChunk(Chunk& c) {
+        c.counted = false;
+        c.lastCounted = 0;
+        c.maxColumn = 0;
+        const char* p = c.begin;
+        while (p < c.end) {
+            const char* lineEnd = static_cast<const char*> (memchr(p, '\n', c.end - p));
+            const bool terminated = (lineEnd != NULL);
+            if (!terminated) {
+                lineEnd = c.end;
+            }
+            const size_t line = c.lineNnz.size();
+            const size_t first = c.columns.size();
+            bool sorted = true;
+
+            const char* q = p;
+            while (true) {
+                while (q < lineEnd && isSpace(*q)) ++q;
+                if (q == lineEnd) break;
+                const char* tokenEnd = q;
+                while (tokenEnd < lineEnd && !isSpace(*tokenEnd)) ++tokenEnd;
+
+                size_t column;
+                Real value;
+                parseToken(q, tokenEnd, column, value);
+                if (c.columns.size() > first && column <= c.columns.back()) {
+                    sorted = false;
+                }
+                c.columns.push_back(column);
+                c.values.push_back(value);
+                c.maxColumn = std::max(c.maxColumn, column);
+                q = tokenEnd;
+            }
+            if (!sorted) {
+                sortLine(c, first);
+            }
+            const size_t nnz = c.columns.size() - first;
+            c.lineNnz.push_back(nnz);
+            if (nnz > 0 || (p == lineEnd && terminated)) {
+                c.counted = true;
+                c.lastCounted = line;
+            }
+            p = terminated ? lineEnd + 1 : c.end;
+        }
+    }
+
+
+    class ParseTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        ParseTask(std::vector<Chunk>& chunks) : chunks(chunks) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            for (size_t i = begin; i < end; ++i) {
+                parseChunk(chunks[i]);
+            }
+        }
+
+    private:
+        std::vector<Chunk>& chunks;
+    };
+
+
+    /**
+     * Copies the entries of the chunks to their place in the result.
+     */
+    class CopyTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        CopyTask(std::vector<Chunk>& chunks, const std::vector<size_t>& offsets, std::vector<size_t>& columns, std::vector<Real>& values) :
+        chunks(chunks), offsets(offsets), columns(columns), values(values) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            for (size_t i = begin; i < end; ++i) {
+                std::copy(chunks[i].columns.begin(), chunks[i].columns.end(), columns.begin() + offsets[i]);
+                std::copy(chunks[i].values.begin(), chunks[i].values.end(), values.begin() + offsets[i]);
+                // Free the memory early
+                std::vector<size_t>().swap(chunks[i].columns);
+                std::vector<Real>().swap(chunks[i].values);
+            }
+        }
+
+    private:
+        std::vector<Chunk>& chunks;
+        const std::vector<size_t>& offsets;
+        std::vector<size_t>& columns;
+        std::vector<Real>& values;
+    };
+}
+
+
+void cofi::io::loadSVMLight(const std::string& filename, CSRData& data, const size_t nThreads) {
+    MappedFile file(filename);
+    const char* bytes = file.data();
+    const size_t n = file.size();
+
+    // Split the file into chunks at line boundaries
+    const size_t nChunks = (n < MIN_PARALLEL_SIZE || nThreads <= 1) ? 1 : 4 * nThreads;
+    std::vector<Chunk> chunks(nChunks);
+    size_t start = 0;
+    for (size_t i = 0; i < nChunks; ++i) {
+        size_t end = n;
+        if (i + 1 < nChunks) {
+            end = std::max(start, (n * (i + 1)) / nChunks);
+            if (end > 0 && end < n) {
+                const void* nl = memchr(bytes + end - 1, '\n', n - end + 1);
+                end = (nl == NULL) ? n : static_cast<const char*> (nl) - bytes + 1;
+            }
+        }
+        chunks[i].begin = bytes + start;
+        chunks[i].end = bytes + end;
+        start = end;
+    }
+
+    ParseTask parse(chunks);
+    cofi::parallel::forEach(parse, nChunks, nThreads);
+
+    // Determine the dimensions the way IndexValueScanner does
+    size_t lines = 0;
+    size_t nnz = 0;
+    bool counted = false;
+    size_t lastCounted = 0;
+    bool hasEntries = false;
+    size_t maxColumn = 0;
+    std::vector<size_t> offsets(nChunks);
+    for (size_t i = 0; i < nChunks; ++i) {
+        if (chunks[i].counted) {
+            counted = true;
+            lastCounted = lines + chunks[i].lastCounted;
+        }
+        if (!chunks[i].columns.empty()) {
+            hasEntries = true;
+            maxColumn = std::max(maxColumn, chunks[i].maxColumn);
+        }
+        offsets[i] = nnz;
+        lines += chunks[i].lineNnz.size();
+        nnz += chunks[i].columns.size();
+    }
+    const size_t rows = counted ? lastCounted + 1 : 1;
+    const size_t cols = hasEntries ? maxColumn + 1 : 1;
+
+    // Lines after the last counted one are empty
+    std::vector<size_t> rowStart(rows + 1, 0);
+    size_t row = 0;
+    for (size_t i = 0; i < nChunks; ++i) {
+        for (size_t l = 0; l < chunks[i].lineNnz.size() && row < rows; ++l, ++row) {
+            rowStart[row + 1] = rowStart[row] + chunks[i].lineNnz[l];
+        }
+    }
+    for (; row < rows; ++row) {
+        rowStart[row + 1] = rowStart[row];
+    }
+    assert(rowStart[rows] == nnz);
+
+    std::vector<size_t> columns(nnz);
+    std::vector<Real> values(nnz);
+    CopyTask copy(chunks, offsets, columns, values);
+    cofi::parallel::forEach(copy, nChunks, nThreads);
+
+    data.adopt(rows, cols, rowStart, columns, values);
+}
+
+
+cofi::io::CSRData::CSRData(void) : rows(0), cols(0), entries(0), rowStartData(NULL), columnData(NULL), valueData(NULL), file(NULL) {
+}
+
+
+cofi::io::CSRData::~CSRData(void) {
+    clear();
+}
+
+
+void cofi::io::CSRData::clear(void) {
+    delete file;
+    file = NULL;
+    std::vector<size_t>().swap(ownedRowStart);
+    std::vector<size_t>().swap(ownedColumns);
+    std::vector<Real>().swap(ownedValues);
+    rows = cols = entries = 0;
+    rowStartData = columnData = NULL;
+    valueData = NULL;
+}
+
+
+void cofi::io::CSRData::adopt(const size_t rows, const size_t cols, std::vector<size_t>& rowStart, std::vector<size_t>& columns, std::vector<Real>& values) {
+    assert(rowStart.size() == rows + 1 && columns.size() == values.size());
+    clear();
+    ownedRowStart.swap(rowStart);
+    ownedColumns.swap(columns);
+    ownedValues.swap(values);
+    this->rows = rows;
+    this->cols = cols;
+    this->entries = ownedValues.size();
+    rowStartData = &ownedRowStart[0];
+    columnData = ownedColumns.empty() ? NULL : &ownedColumns[0];
+    valueData = ownedValues.empty() ? NULL : &ownedValues[0];
+}
+
+
+void cofi::io::CSRData::adopt(MappedFile* file, const size_t rows, const size_t cols, const size_t nnz, const size_t* rowStart, const size_t* columns, const Real* values) {
+    clear();
+    this->file = file;
+    this->rows = rows;
+    this->cols = cols;
+    this->entries = nnz;
+    rowStartData = rowStart;
+    columnData = columns;
+    valueData = values;
+}
+
+
+namespace {
+
+    /**
+     * Keeps the entries of a CSRData alive inside a matrix.
+     */
+    class CSRStorage : public cofi::DType::Storage {
+    public:
+
+
+        CSRStorage(cofi::io::MappedFile* file, std::vector<size_t>& columns, std::vector<Real>& values) : file(file) {
+            this->columns.swap(columns);
+            this->values.swap(values);
+        }
+
+
+        virtual ~CSRStorage(void) {
+            delete file;
+        }
+
+    private:
+        cofi::io::MappedFile* file;
+        std::vector<size_t> columns;
+        std::vector<Real> values;
+    };
+}
+
+
+void cofi::io::CSRData::moveTo(cofi::DType& m, const size_t rows, const size_t cols) {
+    const size_t nnz = this->nnz();
+    if (nnz > 0 && this->cols > cols) {
+        throw CoFiException("cofi::io::CSRData::moveTo(): Index violation, the matrix has too few columns.");
+    }
+    if (this->rows > rows && rowStartData[rows] != nnz) {
+        throw CoFiException("cofi::io::CSRData::moveTo(): Index violation, the matrix has too few rows.");
+    }
+
+    // The rows beyond the data are empty
+    std::vector<size_t> rowStart(rows + 1, nnz);
+    std::copy(rowStartData, rowStartData + std::min(this->rows, rows) + 1, rowStart.begin());
+    const size_t* columns = columnData;
+    const Real* values = valueData;
+    CSRStorage* storage = new CSRStorage(file, ownedColumns, ownedValues);
+    file = NULL;
+    clear();
+    m.adopt(rows, cols, rowStart, storage, columns, values);
+}
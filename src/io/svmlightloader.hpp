@@ -0,0 +1,156 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _SVMLIGHTLOADER_HPP_
+#define _SVMLIGHTLOADER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace cofi {
+    namespace io {
+
+        class MappedFile;
+
+        /**
+         * A sparse matrix in compressed sparse row (CSR) form.
+         *
+         * The entries of row i are at the positions [rowStart[i], rowStart[i+1])
+         * of columns and values. Within a row, the columns are strictly
+         * increasing.
+         *
+         * The arrays are either owned by this object or point into a mapped
+         * cache file, see csrcache.hpp.
+         */
+        class CSRData {
+        public:
+            CSRData(void);
+
+            ~CSRData(void);
+
+
+            /**
+             * @return the number of rows, as determined by SVMLightReader.
+             */
+            size_t size1(void) const {
+                return rows;
+            }
+
+
+            /**
+             * @return the number of columns, as determined by SVMLightReader.
+             */
+            size_t size2(void) const {
+                return cols;
+            }
+
+
+            /**
+             * @return the number of stored entries.
+             */
+            size_t nnz(void) const {
+                return entries;
+            }
+
+
+            /**
+             * @return the rows+1 start positions of the rows.
+             */
+            const size_t* rowStart(void) const {
+                return rowStartData;
+            }
+
+
+            const size_t* columns(void) const {
+                return columnData;
+            }
+
+
+            const Real* values(void) const {
+                return valueData;
+            }
+
+
+            /**
+             * Takes over the given arrays. They are empty afterwards.
+             */
+            void adopt(const size_t rows, const size_t cols, std::vector<size_t>& rowStart, std::vector<size_t>& columns, std::vector<Real>& values);
+
+
+            /**
+             * Uses the given arrays, which point into the given file. The
+             * file is deleted together with this object.
+             */
+            void adopt(MappedFile* file, const size_t rows, const size_t cols, const size_t nnz, const size_t* rowStart, const size_t* columns, const Real* values);
+
+
+            /**
+             * Hands the data over to the given matrix without copying the
+             * entries: The matrix takes over the arrays or the mapped file.
+             * This data is empty afterwards.
+             *
+             * The dimensions of the matrix may differ from the ones of this
+             * data. Rows and columns beyond the data are empty.
+             *
+             * @param m the matrix to replace the contents of.
+             * @param rows the number of rows of the matrix.
+             * @param cols the number of columns of the matrix.
+             * @throws CoFiException if an entry does not fit into the matrix.
+             *         The data is unchanged in this case.
+             */
+            void moveTo(cofi::DType& m, const size_t rows, const size_t cols);
+
+        private:
+            // Not implemented, the data may be mapped.
+            CSRData(const CSRData& other);
+            CSRData& operator=(const CSRData& other);
+
+            void clear(void);
+
+            size_t rows;
+            size_t cols;
+            size_t entries;
+            const size_t* rowStartData;
+            const size_t* columnData;
+            const Real* valueData;
+
+            // The storage, if the data was not mapped
+            std::vector<size_t> ownedRowStart;
+            std::vector<size_t> ownedColumns;
+            std::vector<Real> ownedValues;
+            MappedFile* file;
+        };
+
+
+        /**
+         * Loads an SVMLight file into CSR form.
+         *
+         * This yields the same matrix as SVMLightReader with
+         * IndexValueScanner and IndexValueInserter, but reads the file only
+         * once: The file is mapped into memory and split into chunks at line
+         * boundaries. The chunks are parsed in parallel into per chunk CSR
+         * arrays, which are then concatenated.
+         *
+         * @param filename the file to read.
+         * @param data the data read.
+         * @param nThreads the number of threads to parse with.
+         */
+        void loadSVMLight(const std::string& filename, CSRData& data, const size_t nThreads);
+    }
+}
+#endif /* _SVMLIGHTLOADER_HPP_ */
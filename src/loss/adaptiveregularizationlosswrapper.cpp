@@ -7,7 +7,7 @@ void cofi::AdaptiveRegularizationLossWrapper::ComputeLossGradient(WType& w, Real
     grad *= this->weight;
 }
 
-void cofi::AdaptiveRegularizationLossWrapper::ComputeLossPartGradient(WType& w, Real &loss, cofi::WType& grad){
+void cofi::AdaptiveRegularizationLossWrapper::ComputeLossPartGradient(WType& w, Real &loss, cofi::YType& grad){
     this->lossFunction.ComputeLossPartGradient(w, loss, grad);
     // loss *= this->weight;
     // grad *= this->weight;
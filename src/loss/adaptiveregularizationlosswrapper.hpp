@@ -38,10 +38,21 @@ namespace cofi{
          *
          * It should never be called and raises an exception if so.
          */
-        void ComputeLossPartGradient(WType& w, Real &loss, ublas::matrix<Real>& grad);
+        void ComputeLossPartGradient(WType& w, Real &loss, YType& grad);
+
+        /**
+         * Sets the weight, such that the wrapper can be reused for another user.
+         */
+        void setWeight(const Real weight) {
+            this->weight = weight;
+        }
+
+        void reset(void) {
+            lossFunction.reset();
+        }
         
     private:
-        const Real weight;
+        Real weight;
         CofiLossFunction& lossFunction;
     };
     
@@ -24,7 +24,17 @@ public:
      * @param grad (out) the computed partial gradient.
      *
      */
-    virtual void ComputeLossPartGradient(cofi::WType& w, Real& loss, ublas::matrix<Real>& grad) = 0;
+    virtual void ComputeLossPartGradient(cofi::WType& w, Real& loss, cofi::YType& grad) = 0;
+
+
+    /**
+     * Tells the model that its X and Y now hold the data of another user.
+     *
+     * Models are reused across users, so those which cache quantities derived
+     * from X or Y need to recompute them here. The default does nothing.
+     */
+    virtual void reset(void) {
+    }
 };
 
 #endif
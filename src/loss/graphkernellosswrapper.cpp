@@ -2,63 +2,168 @@
 #include "core/types.hpp"
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 #include "core/cofiexception.hpp"
-#include "cofi/useriterator.hpp"
+#include "utils/parallel.hpp"
 
-cofi::GraphKernelLossWrapper::GraphKernelLossWrapper(Problem& p):p(p){}
+namespace {
 
+    /**
+     * Computes the loss and the gradient of the users [begin, end): writes
+     * the gradient of user i to row i of grad and its loss to losses[i].
+     */
+    class UserGradientTask : public cofi::parallel::RangeTask {
+    public:
 
-void cofi::GraphKernelLossWrapper::ComputeLossGradient(WType& w, Real& loss, cofi::WType& grad){
 
-    assert(w.size1() == grad.size1());
-    assert(w.size2() == grad.size2());
+        UserGradientTask(cofi::Problem& p, const cofi::GraphKernelLossWrapper::Compressed& rows,
+                std::vector<cofi::UserIterator*>& iterators, std::vector<cofi::WType>& gradients,
+                const cofi::WType& w, cofi::WType& grad, std::vector<Real>& losses) :
+        p(p), rows(rows), iterators(iterators), gradients(gradients), w(w), grad(grad), losses(losses) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            cofi::UserIterator& iter = *(iterators[thread]);
+            cofi::WType& gradient = gradients[thread];
+            const size_t u = p.getU().size1();
+            const size_t d = w.size2();
+            for (size_t user = begin; user < end; ++user) {
+                iter.advanceTo(user);
+                // W = U[user] + (S*A)[user], the latter from the row of S
+                cofi::WType& thisW = iter.getW();
+                for (size_t k = 0; k < d; ++k) {
+                    Real sa = 0.0;
+                    for (size_t e = rows.start[user]; e < rows.start[user + 1]; ++e) {
+                        sa += rows.value[e] * w(u + rows.index[e], k);
+                    }
+                    thisW(k, 0) = w(user, k) + sa;
+                }
+
+                Real thisLoss = 0;
+                if (p.usingAdaptiveRegularization()) {
+                    iter.getWeightedLoss().ComputeLossGradient(thisW, thisLoss, gradient);
+                } else {
+                    iter.getLoss().ComputeLossGradient(thisW, thisLoss, gradient);
+                }
+                ublas::row(grad, user) = ublas::column(gradient, 0);
+                losses[user] = thisLoss;
+            }
+        }
+
+    private:
+        cofi::Problem& p;
+        const cofi::GraphKernelLossWrapper::Compressed& rows;
+        std::vector<cofi::UserIterator*>& iterators;
+        std::vector<cofi::WType>& gradients;
+        const cofi::WType& w;
+        cofi::WType& grad;
+        std::vector<Real>& losses;
+    };
+
+
+    /**
+     * Computes the gradient of the items [begin, end): row u + j of grad is
+     * the sum of S[i,j] grad[i] over the users i who rated item j.
+     */
+    class ItemGradientTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        ItemGradientTask(const cofi::GraphKernelLossWrapper::Compressed& columns, const size_t u, cofi::WType& grad) :
+        columns(columns), u(u), grad(grad) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            const size_t d = grad.size2();
+            for (size_t item = begin; item < end; ++item) {
+                for (size_t k = 0; k < d; ++k) {
+                    Real g = 0.0;
+                    for (size_t e = columns.start[item]; e < columns.start[item + 1]; ++e) {
+                        g += columns.value[e] * grad(columns.index[e], k);
+                    }
+                    grad(u + item, k) = g;
+                }
+            }
+        }
+
+    private:
+        const cofi::GraphKernelLossWrapper::Compressed& columns;
+        const size_t u;
+        cofi::WType& grad;
+    };
+}
+
+
+cofi::GraphKernelLossWrapper::GraphKernelLossWrapper(Problem& p) : p(p), nThreads(cofi::parallel::getNumberOfThreads()) {
+    typedef cofi::SType::const_iterator1 itr1;
+    typedef cofi::SType::const_iterator2 itr2;
+    const cofi::SType& S = p.getS();
     const size_t u = p.getU().size1();
     const size_t m = p.getNumberOfItems();
-    const size_t d = p.getDimW();
-    //Clear gradient
-    grad.clear();
-    // Copy the given W back into the problem
-    p.getU() = ublas::subrange(w, 0, u, 0, d);
-    p.getA() = ublas::subrange(w, u, u+m, 0, d);
-    
-    //Initialize iterator over nonzero elements of D
-    itr1 mit1 = p.getS().begin1();
-    
-    // Compute the gradient for each user and store it in grad's first nUsers rows
-    cofi::UserIterator userIter = p.getTrainIterator();
-    size_t counter = 0;
-    loss=0.0;
-
-    while(userIter.hasNext()){
-        userIter.advance();
-        cofi::WType& thisW = userIter.getW(); // We operate on the plain W
-        cofi::WType thisGradient(thisW.size1(), thisW.size2());
-
-        Real thisLoss = 0;
-        if(p.usingAdaptiveRegularization()){
-            userIter.getWeightedLoss().ComputeLossGradient(thisW, thisLoss, thisGradient); 
-        }
-        else{
-            userIter.getLoss().ComputeLossGradient(thisW, thisLoss, thisGradient); 
+    assert(S.size1() <= u && S.size2() <= m);
+
+    // Both forms of S, the columns keep the users in increasing order
+    rows.start.assign(u + 1, 0);
+    columns.start.assign(m + 1, 0);
+    for (itr1 r = S.begin1(); r != S.end1(); ++r) {
+        for (itr2 e = r.begin(); e != r.end(); ++e) {
+            rows.index.push_back(e.index2());
+            rows.value.push_back(*e);
+            rows.start[e.index1() + 1] += 1;
+            columns.start[e.index2() + 1] += 1;
         }
-        
-        ublas::row(grad, counter) = ublas::column(thisGradient, 0);
-        
-        itr2 mit2 = mit1.begin();
-     
-       // Compute column component of S'grad and store it in remaining rows of grad 
-       while(mit2 != mit1.end()){
-           ublas::row(grad, mit2.index2() + u) += p.getS()(counter, mit2.index2()) * column(thisGradient,0);         
-            ++mit2;
+    }
+    for (size_t i = 0; i < u; ++i) {
+        rows.start[i + 1] += rows.start[i];
+    }
+    for (size_t j = 0; j < m; ++j) {
+        columns.start[j + 1] += columns.start[j];
+    }
+    columns.index.resize(rows.index.size());
+    columns.value.resize(rows.value.size());
+    std::vector<size_t> next(columns.start.begin(), columns.start.end() - 1);
+    for (size_t i = 0; i < u; ++i) {
+        for (size_t e = rows.start[i]; e < rows.start[i + 1]; ++e) {
+            const size_t at = next[rows.index[e]]++;
+            columns.index[at] = i;
+            columns.value[at] = rows.value[e];
         }
-        ++mit1; 
-         
-        loss += thisLoss;
-        counter += 1;
     }
 
-    assert(counter == u);
-       
-   // Compute S'grad and store it in the remaining rows of grad
-   // subrange(grad,u,u+m,0,d) = prod(trans(p.getS()), subrange(grad, 0, u, 0, d));
-   // subrange(grad,u,u+m,0,d) *= 0;
+    for (size_t i = 0; i < nThreads; ++i) {
+        iterators.push_back(new cofi::UserIterator(p, cofi::UserIterator::TRAINING));
+    }
+    gradients.assign(nThreads, cofi::WType(p.getDimW(), 1));
+    losses.assign(u, 0.0);
+}
+
+
+cofi::GraphKernelLossWrapper::~GraphKernelLossWrapper() {
+    for (size_t i = 0; i < iterators.size(); ++i) {
+        delete iterators[i];
+    }
+}
+
+
+void cofi::GraphKernelLossWrapper::ComputeLossGradient(WType& w, Real& loss, cofi::WType& grad){
+
+    assert(w.size1() == grad.size1());
+    assert(w.size2() == grad.size2());
+    const size_t u = p.getU().size1();
+    const size_t m = p.getNumberOfItems();
+    assert(w.size1() == u + m);
+    assert(w.size2() == p.getDimW());
+
+    // U and A are read from w directly, the problem is updated once BMRM is done
+    UserGradientTask users(p, rows, iterators, gradients, w, grad, losses);
+    cofi::parallel::forEach(users, u, nThreads, 8);
+
+    ItemGradientTask items(columns, u, grad);
+    cofi::parallel::forEach(items, m, nThreads, 64);
+
+    // Sum up in the order of the users
+    loss = 0.0;
+    for (size_t i = 0; i < u; ++i) {
+        loss += losses[i];
+    }
 }
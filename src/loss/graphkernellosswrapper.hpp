@@ -7,19 +7,46 @@
 
 #ifndef _GRAPHKERNELLOSSWRAPPER_H
 #define	_GRAPHKERNELLOSSWRAPPER_H
+#include <vector>
 #include "core/types.hpp"
 #include "bmrm/lossfunction.hpp"
 #include "cofi/problem.hpp"
+#include "cofi/useriterator.hpp"
 
 namespace cofi{
+    /**
+     * The loss of the user phase with the graph kernel, where the users are
+     * represented by U + S*A. w stacks U on top of A.
+     *
+     * The users are evaluated in parallel. (S*A)[i] is computed from the
+     * nonzeros of row i of S when user i is evaluated, and the gradient of A
+     * as S'*grad(U) from the nonzeros of the columns of S, in parallel over
+     * the items. Both sum in the same order as a sequential pass over S, so
+     * the result does not depend on the number of threads.
+     */
     class GraphKernelLossWrapper : public LossFunction{
     public:
         GraphKernelLossWrapper(Problem& p);
+        ~GraphKernelLossWrapper();
         void ComputeLossGradient(WType& w, Real &loss, cofi::WType& grad);
+
+        /**
+         * S in compressed row (or column) form: the entries of row i are
+         * index[start[i]] ... index[start[i+1]-1] with the given values.
+         */
+        struct Compressed {
+            std::vector<size_t> start;
+            std::vector<size_t> index;
+            std::vector<Real> value;
+        };
     private:
-        typedef cofi::DType::const_iterator1 itr1;
-        typedef cofi::DType::const_iterator2 itr2;
         Problem& p;
+        const size_t nThreads;
+        Compressed rows;
+        Compressed columns;
+        std::vector<UserIterator*> iterators; // One per thread
+        std::vector<WType> gradients;         // One per thread
+        std::vector<Real> losses;             // One per user
     };
 }
 
@@ -1,8 +1,10 @@
 #include "leastsquaredomainmodel.hpp"
 #include <cassert>
+#include <cmath>
+#include "core/cofiexception.hpp"
 
 
-LeastSquareDomainModel::LeastSquareDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y) : X(X), Y(Y) {
+LeastSquareDomainModel::LeastSquareDomainModel(const cofi::XType& X, const cofi::YType& Y) : X(X), Y(Y) {
     assert(X.size1() == Y.size1());
 }
 
@@ -11,21 +13,36 @@ void LeastSquareDomainModel::ComputeLossGradient(cofi::WType& w, Real &loss, cof
     assert(w.size1() == X.size2());
     assert(w.size1() == grad.size1());
     assert(w.size2() == grad.size2());
-    // Gradient with respect to f
-    ublas::matrix<Real> g(Y.size1(), Y.size2());
-    ComputeLossPartGradient(w, loss, g);
+    // One pass over the rows of X: predict, take the loss and add the row to
+    // the gradient with respect to w, in the order of X.multiply() and
+    // X.multiplyTransposed().
+    const size_t d = X.size2();
+    grad.clear();
+    loss = 0;
+    if (d == 0) return;
+    const Real* wData = &(w.data()[0]);
+    Real* gradData = &(grad.data()[0]);
+    for (size_t i = 0; i < Y.size1(); i++) {
+        const Real* row = X.row(i);
+        Real f_i = 0.0;
+        for (size_t j = 0; j < d; j++) {
+            f_i += row[j] * wData[j];
+        }
+        const Real value = f_i - Y(i, 0);
+        const Real gradient_i = 2 * value;
+        loss += value*value;
+        for (size_t j = 0; j < d; j++) {
+            gradData[j] += gradient_i * row[j];
+        }
+    }
     assert(loss >= 0);
-
-    // Make gradient with respect to w
-    grad = prod(trans(X), g);
-
 }
 
 
-void LeastSquareDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad) {
+void LeastSquareDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad) {
     assert(Y.size1() == grad.size1());
     assert(Y.size2() == grad.size2());
-    const ublas::matrix<Real> f = prod(X, w);
+    X.multiply(w, f);
     assert(f.size1() == Y.size1());
     assert(f.size2() == Y.size2());
 
@@ -40,5 +57,100 @@ void LeastSquareDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss,
 }
 
 
+Real LeastSquareDomainModel::solve(cofi::WType& w, const Real lambda, const Real weight, const size_t offsetColumn) {
+    assert(w.size1() == X.size2() && w.size2() == 1);
+    const size_t d = X.size2();
+    const bool useOffset = offsetColumn < d;
+
+    // (lambda I + 2 weight X'X) w = 2 weight X'(Y - offset), where the
+    // offset column of X moves to the right hand side
+    normal.assign(d * d, 0.0);
+    rhs.assign(d, 0.0);
+    Real* A = d > 0 ? &normal[0] : NULL;
+    Real* b = d > 0 ? &rhs[0] : NULL;
+    for (size_t i = 0; i < Y.size1(); i++) {
+        const Real* row = X.row(i);
+        const Real y_i = useOffset ? Y(i, 0) - row[offsetColumn] : Y(i, 0);
+        for (size_t j = 0; j < d; j++) {
+            const Real x_j = row[j];
+            b[j] += x_j * y_i;
+            for (size_t k = 0; k <= j; k++) {
+                A[j * d + k] += x_j * row[k];
+            }
+        }
+    }
+    for (size_t j = 0; j < d; j++) {
+        b[j] *= 2 * weight;
+        for (size_t k = 0; k <= j; k++) {
+            A[j * d + k] *= 2 * weight;
+        }
+        A[j * d + j] += lambda;
+    }
+    if (useOffset) {
+        // Pin the offset entry to 0
+        for (size_t k = 0; k < d; k++) {
+            A[offsetColumn * d + k] = 0.0;
+            A[k * d + offsetColumn] = 0.0;
+        }
+        A[offsetColumn * d + offsetColumn] = 1.0;
+        b[offsetColumn] = 0.0;
+    }
+
+    // Cholesky decomposition A = L L' into the lower triangle
+    for (size_t j = 0; j < d; j++) {
+        Real diagonal = A[j * d + j];
+        for (size_t k = 0; k < j; k++) {
+            diagonal -= A[j * d + k] * A[j * d + k];
+        }
+        if (!(diagonal > 0)) {
+            throw cofi::NumericException("LeastSquareDomainModel::solve: The normal equations are not positive definite.");
+        }
+        diagonal = std::sqrt(diagonal);
+        A[j * d + j] = diagonal;
+        for (size_t i = j + 1; i < d; i++) {
+            Real value = A[i * d + j];
+            for (size_t k = 0; k < j; k++) {
+                value -= A[i * d + k] * A[j * d + k];
+            }
+            A[i * d + j] = value / diagonal;
+        }
+    }
+
+    // Solve L z = b, then L' w = z
+    for (size_t i = 0; i < d; i++) {
+        Real value = b[i];
+        for (size_t k = 0; k < i; k++) {
+            value -= A[i * d + k] * b[k];
+        }
+        b[i] = value / A[i * d + i];
+    }
+    for (size_t i = d; i > 0; i--) {
+        Real value = b[i - 1];
+        for (size_t k = i; k < d; k++) {
+            value -= A[k * d + i - 1] * b[k];
+        }
+        b[i - 1] = value / A[(i - 1) * d + i - 1];
+    }
+    for (size_t j = 0; j < d; j++) {
+        w(j, 0) = b[j];
+    }
+
+    // The loss at the solution, with the offset in place
+    if (useOffset) {
+        w(offsetColumn, 0) = 1.0;
+    }
+    X.multiply(w, f);
+    Real loss = 0;
+    for (size_t i = 0; i < Y.size1(); i++) {
+        const Real value = f(i, 0) - Y(i, 0);
+        loss += value*value;
+    }
+    if (useOffset) {
+        w(offsetColumn, 0) = 0.0;
+    }
+    return weight * loss;
+}
+
+
 LeastSquareDomainModel::~LeastSquareDomainModel(void) {
 }
@@ -1,11 +1,16 @@
 #ifndef _LEASTSQUAREDOMAINMODEL_HPP_
 #define _LEASTSQUAREDOMAINMODEL_HPP_
 
+#include <vector>
+
 #include "cofilossfunction.hpp"
 
 /**
  * LeastSquare Loss.
  *
+ * The loss, the gradient with respect to w and the predictions are computed
+ * in a single pass over the rows of X. As the problem of a user is a ridge
+ * regression, it can also be solved directly, see solve().
  */
 
 class LeastSquareDomainModel : public CofiLossFunction{
@@ -16,18 +21,36 @@ public:
      * @param Y the labels for the given samples
      */
     
-    LeastSquareDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y);
+    LeastSquareDomainModel(const cofi::XType& X, const cofi::YType& Y);
     ~LeastSquareDomainModel(void);
     
     
     void ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
-    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
+    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad);
+
+
+    /**
+     * Computes the minimizer of lambda/2 |w|^2 + weight * loss(w) from the
+     * normal equations by a Cholesky decomposition, in place of BMRM.
+     *
+     * @param w the solution, of size X.size2() x 1.
+     * @param offsetColumn if smaller than X.size2(), that entry of w is 1
+     *        for the loss and 0 in the solution, as done by UserLoss.
+     * @return weight * loss(w) at the solution.
+     * @throws NumericException if the normal equations are not positive
+     *         definite.
+     */
+    Real solve(cofi::WType& w, const Real lambda, const Real weight, const size_t offsetColumn);
     
     
 private:
     // Attributes
-    const ublas::matrix<Real>& X;
-    const ublas::matrix<Real>& Y;
+    const cofi::XType& X;
+    const cofi::YType& Y;
+    cofi::YType f; // Workspace for the prediction
+    cofi::YType g; // Workspace for the gradient with respect to f
+    std::vector<Real> normal; // Workspace for the normal equations of solve()
+    std::vector<Real> rhs; // Workspace for their right hand side
 };
 
 #endif
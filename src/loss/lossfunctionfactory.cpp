@@ -26,37 +26,52 @@
 #include "loss/leastsquaredomainmodel.hpp"
 #include "loss/preferencerankingdomainmodel.hpp"
 
-LossFunctionFactory::LossFunctionFactory(void) {
+LossFunctionFactory::LossFunctionFactory(void) : ndcgTrainK(0), ndcgCExponent(0.0), ordinalQuadratic(false) {
     Configuration& conf = Configuration::getInstance();
     std::string name = conf.getString("cofi.loss");
     if (name == "NDCG") {
         std::clog << "DomainModelFactory::DomainModelFactory: Using NDCG" << std::endl;
         m = NDCG;
+        ndcgTrainK = conf.getInt("loss.ndcg.trainK");
+        ndcgCExponent = conf.getDouble("loss.ndcg.c_exponent");
+        if (ndcgTrainK == 0) {
+            std::clog << "DomainModelFactory::DomainModelFactory: Training NDCG@infinity" << std::endl;
+        }
     } else if (name == "REGRESSION") {
         std::clog << "DomainModelFactory::DomainModelFactory: Using REGRESSION" << std::endl;
         m = REGRESSION;
     } else if (name == "ORDINAL") {
         std::clog << "DomainModelFactory::DomainModelFactory: Using ORDINAL" << std::endl;
         m = ORDINAL;
+        ordinalQuadratic = conf.getInt("loss.ordinal.quadratic") == 1;
+        if (ordinalQuadratic) {
+            std::clog << "DomainModelFactory::DomainModelFactory: Looping over all pairs of ratings" << std::endl;
+        }
     } else {
         throw cofi::ConfigException("DomainModelFactory: No Domain Model choosen in the configuration!");
     }
 }
 
 
-CofiLossFunction * LossFunctionFactory::get(ublas::matrix<Real>& X, ublas::matrix<Real>& Y) {
+CofiLossFunction * LossFunctionFactory::get(cofi::XType& X, cofi::YType& Y) {
+    return create(m, X, Y, ndcgTrainK, ndcgCExponent, ordinalQuadratic);
+}
+
+
+CofiLossFunction * LossFunctionFactory::create(ModelEnum m, cofi::XType& X, cofi::YType& Y, const size_t ndcgTrainK, const double ndcgCExponent,
+        const bool ordinalQuadratic) {
     if (X.size1() != Y.size1()) {
         throw cofi::InvalidParameterException("X and Y differ in the number of rows.");
     }
     switch (m) {
         case NDCG:
-            return new NDCGDomainModel(X, Y);
+            return new NDCGDomainModel(X, Y, ndcgTrainK, ndcgCExponent);
 
         case REGRESSION:
             return new LeastSquareDomainModel(X, Y);
 
         case ORDINAL:
-            return new PreferenceRankingDomainModel(X, Y);
+            return new PreferenceRankingDomainModel(X, Y, ordinalQuadratic);
 
         default:
             throw cofi::InvalidParameterException("DomainModelFactory::get(): unable to create a domain model.");
@@ -11,7 +11,32 @@ public:
         NDCG, REGRESSION, ORDINAL
     };
 
-    CofiLossFunction* get(ublas::matrix<Real>& X, ublas::matrix<Real>& Y);
+    CofiLossFunction* get(cofi::XType& X, cofi::YType& Y);
+
+    /**
+     * Creates a loss function of the given kind without consulting the
+     * configuration, e.g. for a model trained elsewhere.
+     *
+     * @param ordinalQuadratic whether ORDINAL loops over all pairs of ratings,
+     *        which gives the same results as the default, only slower.
+     */
+    static CofiLossFunction* create(ModelEnum m, cofi::XType& X, cofi::YType& Y, const size_t ndcgTrainK, const double ndcgCExponent,
+            const bool ordinalQuadratic = false);
+
+    /**
+     * @return the kind of loss function get() creates.
+     */
+    ModelEnum getModel(void) const {
+        return m;
+    }
+
+    size_t getNDCGTrainK(void) const {
+        return ndcgTrainK;
+    }
+
+    double getNDCGCExponent(void) const {
+        return ndcgCExponent;
+    }
 
     /**
      * @return a reference to the current instance.
@@ -29,6 +54,13 @@ private:
 
     static LossFunctionFactory* instance;
     ModelEnum m;
+
+    // The NDCG parameters, read once such that get() does not touch the configuration.
+    size_t ndcgTrainK;
+    double ndcgCExponent;
+
+    // Whether ORDINAL uses the O(n^2) loop over all pairs
+    bool ordinalQuadratic;
 };
 
 #endif /* _DOMAINMODELFACTORY_HPP_ */
@@ -30,30 +30,229 @@
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 #include "cofi/useriterator.hpp"
 #include "core/cofiexception.hpp"
+#include "utils/parallel.hpp"
+#include "loss/lossfunctionfactory.hpp"
+#include "utils/configuration.hpp"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+
+namespace {
+
+    /**
+     * Adds the gradient contributions of the users [first, last) to grad.
+     *
+     * @param userIter the iterator to set up the users with.
+     * @param atmp the workspace for the per user gradient.
+     * @return the loss of these users.
+     */
+    Real accumulateUsers(cofi::Problem& p, cofi::UserIterator& userIter, cofi::YType& atmp, const size_t first, const size_t last, cofi::WType& grad) {
+        Real Loss = 0.0; // per block loss
+        if (first == last) return Loss;
+
+        userIter.advanceTo(first);
+        for (size_t user = first; user < last; ++user) {
+            if (user > first) {
+                userIter.advance();
+            }
+            cofi::WType& W = userIter.getW();
+            const int rowInU = userIter.getRowInU();
+
+            CofiLossFunction& model = userIter.getLoss();
+            const size_t seenMovies = userIter.getX().size1();
+            // Per user gradient
+            atmp.resize(userIter.getY().size1(), userIter.getY().size2(), false);
+
+            Real tmpLoss = 0.0;
+            model.ComputeLossPartGradient(W, tmpLoss, atmp);
+
+            Loss = Loss + tmpLoss;
+
+            // Decompose the matrix multiplication (\partial_F L)' * U into operations
+            // over each gradient (seems much faster!)
+            // Row row_i of X is the movie the gradient entry belongs to.
+            const cofi::XType& X = userIter.getX();
+            for (size_t row_i = 0; row_i < seenMovies; ++row_i) {
+                ublas::row(grad, X.index(row_i)) += atmp(row_i, 0) * ublas::row(p.getU(), rowInU);
+            }
+        }
+        return Loss;
+    }
+
+
+    /**
+     * Computes the gradient of a fixed block of users into its own buffer.
+     *
+     * The users are split into as many contiguous blocks as there are
+     * buffers. Block 0 writes into the gradient itself. As the assignment of
+     * users to buffers does not depend on which thread processes a block, the
+     * result is reproducible.
+     */
+    class BlockGradientTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        BlockGradientTask(cofi::Problem& p, std::vector<cofi::UserIterator*>& iterators, std::vector<cofi::YType>& partGradients, std::vector<cofi::WType*>& gradients, std::vector<Real>& losses) :
+        p(p), iterators(iterators), partGradients(partGradients), gradients(gradients), losses(losses) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t /* thread */) {
+            const size_t nUsers = p.getTrainD().size1();
+            const size_t nBlocks = gradients.size();
+            for (size_t block = begin; block < end; ++block) {
+                cofi::WType& grad = *(gradients[block]);
+                grad.clear();
+                const size_t first = (nUsers * block) / nBlocks;
+                const size_t last = (nUsers * (block + 1)) / nBlocks;
+                losses[block] = accumulateUsers(p, *(iterators[block]), partGradients[block], first, last, grad);
+            }
+        }
+
+    private:
+        cofi::Problem& p;
+        std::vector<cofi::UserIterator*>& iterators;
+        std::vector<cofi::YType>& partGradients;
+        std::vector<cofi::WType*>& gradients;
+        std::vector<Real>& losses;
+    };
+
+
+    /**
+     * Adds the block gradients 1..n to block 0, in block order for every row.
+     */
+    class GradientReductionTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        GradientReductionTask(std::vector<cofi::WType*>& gradients) : gradients(gradients) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t /* thread */) {
+            cofi::WType& grad = *(gradients[0]);
+            for (size_t block = 1; block < gradients.size(); ++block) {
+                ublas::subrange(grad, begin, end, 0, grad.size2()) += ublas::subrange(*(gradients[block]), begin, end, 0, grad.size2());
+            }
+        }
+
+    private:
+        std::vector<cofi::WType*>& gradients;
+    };
+
+
+    /**
+     * The first stage of the item major gradient: computes the loss of the
+     * users [begin, end) and the derivatives for their ratings, which go to
+     * partials[e] for the entry e of D.
+     */
+    class UserPartialTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        UserPartialTask(cofi::Problem& p, std::vector<cofi::UserIterator*>& iterators, std::vector<cofi::YType>& partGradients,
+                std::vector<Real>& partials, std::vector<Real>& losses) :
+        p(p), iterators(iterators), partGradients(partGradients), partials(partials), losses(losses) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t thread) {
+            cofi::UserIterator& userIter = *(iterators[thread]);
+            cofi::YType& atmp = partGradients[thread];
+            const cofi::DType& D = p.getTrainD();
+            for (size_t user = begin; user < end; ++user) {
+                userIter.advanceTo(user);
+                atmp.resize(userIter.getY().size1(), userIter.getY().size2(), false);
+                Real userLoss = 0.0;
+                userIter.getLoss().ComputeLossPartGradient(userIter.getW(), userLoss, atmp);
+                losses[user] = userLoss;
+                const size_t first = D.rowBegin(user);
+                for (size_t row_i = 0; row_i < atmp.size1(); ++row_i) {
+                    partials[first + row_i] = atmp(row_i, 0);
+                }
+            }
+        }
+
+    private:
+        cofi::Problem& p;
+        std::vector<cofi::UserIterator*>& iterators;
+        std::vector<cofi::YType>& partGradients;
+        std::vector<Real>& partials;
+        std::vector<Real>& losses;
+    };
+
+
+    /**
+     * The second stage of the item major gradient: row j of grad is the sum
+     * of partials[e] U[i] over the ratings e of item j by the users i, in
+     * the order of the users.
+     */
+    class ItemGradientTask : public cofi::parallel::RangeTask {
+    public:
+
+
+        ItemGradientTask(cofi::Problem& p, const std::vector<Real>& partials, cofi::WType& grad) :
+        p(p), partials(partials), grad(grad) {
+        }
+
+
+        void run(const size_t begin, const size_t end, const size_t /* thread */) {
+            const cofi::DType& D = p.getTrainD();
+            const cofi::UType& U = p.getU();
+            const size_t d = grad.size2();
+            for (size_t item = begin; item < end; ++item) {
+                Real* g = &(grad.data()[0]) + item * d;
+                std::fill(g, g + d, 0.0);
+                if (item >= D.size2()) continue;
+                for (size_t c = D.columnBegin(item); c < D.columnEnd(item); ++c) {
+                    const Real a = partials[D.entry(c)];
+                    const Real* u = &(U.data()[0]) + D.row(c) * d;
+                    for (size_t k = 0; k < d; ++k) {
+                        g[k] += a * u[k];
+                    }
+                }
+            }
+        }
+
+    private:
+        cofi::Problem& p;
+        const std::vector<Real>& partials;
+        cofi::WType& grad;
+    };
+}
 
 
 cofi::MoviePhaseLossFunction::MoviePhaseLossFunction(cofi::Problem& p) : p(p) {
     nUser = p.getU().size1(); // number of users
     nMovies = p.getM().size1(); // number of movies
-}
-
+    nThreads = std::min<size_t > (cofi::parallel::getNumberOfThreads(), std::max<size_t > (nUser, 1));
+    itemMajor = Configuration::getInstance().getIntAsBool("cofi.moviephase.itemMajor");
+    if (itemMajor && !p.getTrainD().hasColumnIndex()) {
+        throw CoFiException("cofi::MoviePhaseLossFunction: The item major movie phase needs the column index of D");
+    }
+    // Make sure the factory reads its configuration before any worker does.
+    LossFunctionFactory::getInstance();
 
-void cofi::MoviePhaseLossFunction::ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad) {
-    assert(w.size1() == grad.size1());
-    assert(w.size2() == grad.size2());
+    // The iterators and their workspaces are reused across BMRM iterations.
+    partGradients.resize(nThreads);
+    for (size_t i = 0; i < nThreads; ++i) {
+        iterators.push_back(new cofi::UserIterator(p, cofi::UserIterator::TRAINING));
+    }
+}
 
-    // We need to clear the gradient since we now add the result from each column
-    // computation
-    grad.clear();
 
-    //Initialize iterator over nonzero elements of D
-    itr1 mit1 = p.getTrainD().begin1();
+cofi::MoviePhaseLossFunction::~MoviePhaseLossFunction(void) {
+    for (size_t i = 0; i < iterators.size(); ++i) {
+        delete iterators[i];
+    }
+}
 
-    // The (partial derivative of L with respect to f)'
-    //compressed_matrix<double> Atmp(nMovies, nUser, p.getTrainD().nnz());
 
-    // We should get M as w
-    assert(&(p.getM()) == &w);
+void cofi::MoviePhaseLossFunction::ComputeLossGradient(cofi::WType& /* w */, Real &loss, cofi::WType& grad) {
+    // We should get M as w, which we read from p
+    assert(p.getM().size1() == grad.size1());
+    assert(p.getM().size2() == grad.size2());
 
     // Offset management:
     // If we have an offset, we need to make sure that bmrm does not optimize it
@@ -67,44 +266,11 @@ void cofi::MoviePhaseLossFunction::ComputeLossGradient(cofi::WType& w, Real &los
         p.setUserOffsetColumnInMToOne();
     }
 
-    // optimization loop
-    Real Loss = 0.0; // per dataset loss
-    cofi::UserIterator userIter = p.getTrainIterator();
-    while (userIter.hasNext()) {
-
-        userIter.advance();
-        cofi::WType& W = userIter.getW();
-        const int rowInU = userIter.getRowInU();
-
-        CofiLossFunction& model = userIter.getLoss();
-        const size_t seenMovies = userIter.getX().size1();
-        // Per user gradient
-        ublas::matrix<Real> atmp = ublas::matrix<Real > (userIter.getY().size1(), userIter.getY().size2());
-
-        Real tmpLoss = 0.0;
-        model.ComputeLossPartGradient(W, tmpLoss, atmp);
-
-        Loss = Loss + tmpLoss;
-
-        //copy result into Atmp matrix
-        itr2 mit2 = mit1.begin();
-
-        //     Setup matrix a to contain the gradient for each user as one column
-        //        for (size_t row = 0; row < seenMovies ; ++row) {
-        //            Atmp(mit2.index2(), (userID-1)) = atmp(row, 0);
-        //            ++mit2;
-        //        }// all rows
-        //        ++mit1;
-
-        // Decompose the matrix multiplication (\partial_F L)' * U into operations
-        // over each gradient (seems much faster!)
-        for (size_t row_i = 0; row_i < seenMovies; ++row_i) {
-            ublas::row(grad, mit2.index2()) += atmp(row_i, 0) * ublas::row(p.getU(), rowInU);
-            ++mit2;
-        }
-        ++mit1;
+    if (itemMajor) {
+        loss = itemMajorLossGradient(grad);
+    } else {
+        loss = scatterLossGradient(grad);
     }
-    loss = Loss;
 
     if (p.usingUserOffset()) {
         p.setUserOffsetColumnInMToZero();
@@ -113,7 +279,7 @@ void cofi::MoviePhaseLossFunction::ComputeLossGradient(cofi::WType& w, Real &los
             grad(row, cofi::USER_OFFSET_COLUMN) = 0;
 
             // w here is M. Thus, the corresponding column of w should be 0 now.
-            assert(w(row, cofi::USER_OFFSET_COLUMN) == 0);
+            assert(p.getM()(row, cofi::USER_OFFSET_COLUMN) == 0);
         }
 
 
@@ -122,4 +288,67 @@ void cofi::MoviePhaseLossFunction::ComputeLossGradient(cofi::WType& w, Real &los
     //grad = prod(Atmp, p.getU());
 
 }
+
+
+Real cofi::MoviePhaseLossFunction::itemMajorLossGradient(cofi::WType& grad) {
+    const cofi::DType& D = p.getTrainD();
+    assert(grad.size1() >= D.size2());
+    partials.resize(D.nnz());
+    userLosses.resize(D.size1());
+
+    UserPartialTask partialTask(p, iterators, partGradients, partials, userLosses);
+    cofi::parallel::forEach(partialTask, D.size1(), nThreads, 16);
+    ItemGradientTask gradientTask(p, partials, grad);
+    cofi::parallel::forEach(gradientTask, grad.size1(), nThreads, 64);
+
+    // Sum up in the order of the users
+    Real Loss = 0.0;
+    for (size_t user = 0; user < userLosses.size(); ++user) {
+        Loss += userLosses[user];
+    }
+    return Loss;
+}
+
+
+Real cofi::MoviePhaseLossFunction::scatterLossGradient(cofi::WType& grad) {
+    // One gradient buffer per block of users. The first block writes directly
+    // into grad, the buffers of the others are kept across BMRM iterations.
+    partialGradients.resize(nThreads - 1);
+    std::vector<cofi::WType*> gradients(1, &grad);
+    for (size_t i = 0; i < partialGradients.size(); ++i) {
+        if (partialGradients[i].size1() != grad.size1() || partialGradients[i].size2() != grad.size2()) {
+            partialGradients[i].resize(grad.size1(), grad.size2(), false);
+        }
+        gradients.push_back(&partialGradients[i]);
+    }
+
+#ifndef NDEBUG
+    size_t allocationsBefore = 0;
+    for (size_t i = 0; i < iterators.size(); ++i) {
+        allocationsBefore += iterators[i]->getNumberOfAllocations();
+    }
+#endif
+
+    std::vector<Real> losses(nThreads, 0.0);
+    BlockGradientTask gradientTask(p, iterators, partGradients, gradients, losses);
+    cofi::parallel::forEach(gradientTask, gradients.size(), nThreads);
+    if (gradients.size() > 1) {
+        GradientReductionTask reductionTask(gradients);
+        cofi::parallel::forEach(reductionTask, grad.size1(), nThreads, 256);
+    }
+
+#ifndef NDEBUG
+    size_t allocationsAfter = 0;
+    for (size_t i = 0; i < iterators.size(); ++i) {
+        allocationsAfter += iterators[i]->getNumberOfAllocations();
+    }
+    std::clog << "cofi::MoviePhaseLossFunction::ComputeLossGradient: " << (allocationsAfter - allocationsBefore) << " workspace allocations" << std::endl;
+#endif
+
+    Real Loss = 0.0; // per dataset loss
+    for (size_t block = 0; block < losses.size(); ++block) {
+        Loss += losses[block];
+    }
+    return Loss;
+}
 #endif
@@ -22,31 +22,65 @@
 #include "bmrm/lossfunction.hpp"
 
 #include "cofi/problem.hpp"
+#include "cofi/useriterator.hpp"
+#include <vector>
 
 
 namespace cofi{
     /**
      * DomainWrapper.
      *
+     * The gradient is accumulated over the users by cofi.threads threads.
+     * Each thread works on a fixed, contiguous block of users and has its own
+     * gradient buffer. The buffers are summed up in block order, so the result
+     * is reproducible for a given number of threads. The iterators of the
+     * blocks and their workspaces are kept across calls.
+     *
+     * With cofi.moviephase.itemMajor, the gradient is computed in two
+     * stages instead. First, the users are processed in parallel and the
+     * derivative of the loss for every rating is stored. Then, the items
+     * are processed in parallel, every item sums up its ratings from the
+     * column index of D into its own row of the gradient. No buffers need
+     * to be reduced and the result does not depend on the number of threads.
      */
     class MoviePhaseLossFunction : public LossFunction {
         
     public:
         MoviePhaseLossFunction(cofi::Problem& p);
         
-        ~MoviePhaseLossFunction() {}
+        ~MoviePhaseLossFunction();
         void ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
         
 
         
         
     private:
+        /**
+         * Computes the loss and gradient by scattering the gradients of the
+         * users into the blocks.
+         *
+         * @return the loss.
+         */
+        Real scatterLossGradient(cofi::WType& grad);
+
+        /**
+         * Computes the loss and gradient in the two item major stages.
+         *
+         * @return the loss.
+         */
+        Real itemMajorLossGradient(cofi::WType& grad);
+
         // Attributes
         cofi::Problem& p;
-        typedef cofi::DType::const_iterator1 itr1;
-        typedef cofi::DType::const_iterator2 itr2;
         unsigned int nUser;
         unsigned int nMovies;
+        size_t nThreads;
+        std::vector<cofi::WType> partialGradients; // Gradient buffers of the blocks 1..nThreads-1
+        std::vector<cofi::UserIterator*> iterators; // One per block
+        std::vector<cofi::YType> partGradients; // Per user gradient workspace, one per block
+        bool itemMajor;                         // Whether to use itemMajorLossGradient()
+        std::vector<Real> partials;             // The derivative per rating, for the item major stages
+        std::vector<Real> userLosses;           // The loss per user, for the item major stages
         
     };
 }
@@ -16,22 +16,20 @@
 #include <cmath>
 #include <cassert>
 #include "lap.hpp"
-#include "utils/configuration.hpp"
+#include "truncatedassignment.hpp"
 #include "core/cofiexception.hpp"
 #include "utils/ublastools.hpp"
 #include "utils/utils.hpp"
 
 
-NDCGDomainModel::NDCGDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y) :
-X(X), Y(Y) {
+NDCGDomainModel::NDCGDomainModel(const cofi::XType& X, const cofi::YType& Y, const size_t truncation, const double c_exponent) :
+X(X), Y(Y), truncation(truncation), c_exponent(c_exponent), trainK(truncation) {
+    reset();
+}
 
-    Configuration& conf = Configuration::getInstance();
-    this->trainK = conf.getInt("loss.ndcg.trainK");
-    if (this->trainK == 0) {
-        std::clog << "NDCGDomainModel:: Training NDCG@infinity" << std::endl;
-        this->trainK = X.size1();
-    }
-    const double c_exponent = conf.getDouble("loss.ndcg.c_exponent");
+
+void NDCGDomainModel::reset(void) {
+    trainK = (truncation == 0) ? X.size1() : truncation;
 
     // Check the configuration for consistency.
 
@@ -41,16 +39,28 @@ X(X), Y(Y) {
     }
 
     // Compute the sort and the DCG of that sort
-    ublas::vector<size_t> decreasingSort = cofi::ublastools::decreasingSort<ublas::matrix<double> >(Y);
+    ublas::vector<size_t> decreasingSort = cofi::ublastools::decreasingSort<cofi::YType > (Y);
     perfectDCG = dcg(Y, decreasingSort, trainK);
     if (perfectDCG > std::numeric_limits<Real>::max()) {
         throw cofi::NumericException("NDCG computation overflow when computing perfectDCG.");
     }
 
-    // Compute c
-    c = ublas::vector<Real > (Y.size1());
-    for (size_t i = 0; i < c.size(); ++i) {
-        c[i] = pow((i + 1.0), c_exponent);
+    // Compute c and the discounts. They only depend on the position, so
+    // they are only ever grown.
+    if (c.size() < Y.size1()) {
+        const size_t oldSize = c.size();
+        c.resize(Y.size1(), true);
+        discount.resize(Y.size1(), true);
+        for (size_t i = oldSize; i < c.size(); ++i) {
+            c[i] = pow((i + 1.0), c_exponent);
+            discount[i] = log2(i + 2.0);
+        }
+    }
+
+    // The gains of the items of this Y
+    gain.resize(Y.size1(), false);
+    for (size_t j = 0; j < Y.size1(); ++j) {
+        gain[j] = pow(2.0, Y(j, 0)) - 1.0;
     }
 }
 
@@ -59,20 +69,22 @@ void NDCGDomainModel::ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WTyp
     assert(w.size1() == grad.size1());
     assert(w.size2() == grad.size2());
     // Gradient with respect to f
-    ublas::matrix<Real> g(Y.size1(), 1);
+    g.resize(Y.size1(), 1, false);
     ComputeLossPartGradient(w, loss, g);
 
     // Make gradient with respect to w
-    grad = prod(trans(X), g);
+    X.multiplyTransposed(g, grad);
 }
 
 
-void NDCGDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad) {
-    const ublas::matrix<Real> f = prod(X, w);
-    ublas::vector<int> pi(Y.size1());
-
+void NDCGDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad) {
+    X.multiply(w, f);
+    pi.resize(Y.size1(), false);
     find_permutation(f, pi);
-    ublas::vector<size_t> pii = cofi::ublastools::invert_permutation(pi); // Inverse permutation
+    pii.resize(Y.size1(), false); // Inverse permutation
+    for (size_t i = 0; i < Y.size1(); i++) {
+        pii[pi[i]] = i;
+    }
 
     Real scalarProd = 0; // <c, (f_pi - f)>
     for (size_t i = 0; i < Y.size1(); i++) {
@@ -86,7 +98,7 @@ void NDCGDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::
 
 
 /* compute the dcg of Y and store in dy */
-Real NDCGDomainModel::dcg(const ublas::matrix<Real>& y, const ublas::vector<size_t>& pi, const size_t k) {
+Real NDCGDomainModel::dcg(const cofi::YType& y, const ublas::vector<size_t>& pi, const size_t k) {
     if (y.size1() < k) {
         throw cofi::InvalidParameterException("k is bigger than the length of Y.");
     }
@@ -112,8 +124,12 @@ Real NDCGDomainModel::dcg(const ublas::matrix<Real>& y, const ublas::vector<size
 
 
 /* compute the loss and store in value */
-Real NDCGDomainModel::delta(const ublas::vector<size_t>& pi) {
-    const Real theDCG = dcg(Y, pi, trainK);
+Real NDCGDomainModel::delta(const ublas::vector<int>& pi) {
+    Real theDCG = 0.0;
+    for (size_t i = 0; i < trainK; i++) {
+        theDCG += gain[pi[i]] / discount[i];
+    }
+    assert(theDCG > 0.0);
     const Real nDCG = theDCG / perfectDCG;
     const Real result = 1.0 - nDCG;
     assert(result >= 0.0 && result <= 1.0);
@@ -122,27 +138,39 @@ Real NDCGDomainModel::delta(const ublas::vector<size_t>& pi) {
 
 
 /* compute the permutation by linear assignment and store in pi */
-void NDCGDomainModel::find_permutation(const ublas::matrix<Real> &f, ublas::vector<int>& pi) {
-    /* setting up C_ij */
-    Real **C = new Real*[Y.size1()];
+void NDCGDomainModel::find_permutation(const cofi::YType &f, ublas::vector<int>& pi) {
+    const size_t n = Y.size1();
+    if (n == 0) {
+        return;
+    }
+    // f is n x 1 and row major, hence contiguous
+    const Real* fs = &f(0, 0);
+    if (c_exponent <= 0) {
+        // c is non-increasing, which TruncatedAssignment solves without the
+        // dense cost matrix
+        assignment.solve(n, trainK, &gain(0), &discount(0), perfectDCG, &c(0), fs, &pi(0));
+        return;
+    }
 
-    for (size_t i = 0; i < Y.size1(); i++) {
-        C[i] = new Real[Y.size1()];
-        for (size_t j = 0; j < Y.size1(); j++) {
-            if (i < trainK) {
-                C[i][j] = ((pow(2, Y(j, 0)) - 1) / log2(i + 2)) / perfectDCG - c[i] * f(j, 0);
-            } else {
-                C[i][j] = -c[i] * f(j, 0);
+    /* setting up C_ij in one buffer, kept for the next call */
+    costs.resize(n * n);
+    costRows.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        Real* C = &costs[i * n];
+        costRows[i] = C;
+        const Real ci = c[i];
+        if (i < trainK) {
+            const Real di = discount[i];
+            for (size_t j = 0; j < n; j++) {
+                C[j] = (gain[j] / di) / perfectDCG - ci * fs[j];
+            }
+        } else {
+            for (size_t j = 0; j < n; j++) {
+                C[j] = -ci * fs[j];
             }
         }
     }
 
-    ublas::vector<int> row(Y.size1());
-
-    lap(Y.size1(), C, &pi(0), &row(0));
-
-    for (size_t i = 0; i < Y.size1(); i++) {
-        delete C[i];
-    }
-    delete C;
+    row.resize(n, false);
+    lap(n, &costRows[0], &pi(0), &row(0));
 }
@@ -1,7 +1,10 @@
 #ifndef _NDCGDOMAINMODEL_HPP_
 #define _NDCGDOMAINMODEL_HPP_
 
+#include <vector>
+
 #include "cofilossfunction.hpp"
+#include "truncatedassignment.hpp"
 
 /**
  * NDCG Loss.
@@ -13,14 +16,20 @@ public:
     /**
      * @param X the samples to learn from
      * @param Y the labels for the given samples
-     * @param n the truncation cutoff, the n in NDCG@n
+     * @param truncation the truncation cutoff, the n in NDCG@n. 0 means no truncation.
+     * @param c_exponent the exponent of the decay vector c
      */
-    NDCGDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y);
+    NDCGDomainModel(const cofi::XType& X, const cofi::YType& Y, const size_t truncation, const double c_exponent);
     ~NDCGDomainModel(){};
     
     
     void ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
-    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
+    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad);
+
+    /**
+     * Recomputes the truncation and the perfect DCG for the current Y.
+     */
+    void reset(void);
     
     /**
      * Computes the DCG of the given matrix when the matrix is permutated using the given pi.
@@ -28,26 +37,38 @@ public:
      * @param Y the input matrix. Only the first column will be used. Thus, the matrix is treated as a vector.
      * @param pi the permutation vector. pi[i] is the index of element i in the permutated matrix.
      */
-    static Real dcg(const ublas::matrix<Real>& Y, const ublas::vector<size_t>& pi, const size_t k);
+    static Real dcg(const cofi::YType& Y, const ublas::vector<size_t>& pi, const size_t k);
     
     /**
      * Computes the delta in NDCG between the optimal solution and the given permutation.
      *
-     * This version uses the cached vectors a and b.
+     * This version uses the cached gains and discounts.
      *
      */
-    Real delta(const ublas::vector<size_t>& pi);
+    Real delta(const ublas::vector<int>& pi);
     
 private:
     
-    void find_permutation(const ublas::matrix<Real> &f, ublas::vector<int>& pi);
+    void find_permutation(const cofi::YType &f, ublas::vector<int>& pi);
     
     // Attributes
-    const ublas::matrix<Real>& X;
-    const ublas::matrix<Real>& Y;
-    size_t trainK;
+    const cofi::XType& X;
+    const cofi::YType& Y;
+    cofi::YType f; // Workspace for the prediction
+    cofi::YType g; // Workspace for the gradient with respect to f
+    const size_t truncation; // As configured, 0 means no truncation
+    const double c_exponent;
+    size_t trainK; // The truncation used for the current Y
     Real perfectDCG;
     ublas::vector<Real> c;
+    ublas::vector<Real> discount; // log2(i + 2), grown like c
+    ublas::vector<Real> gain; // 2^Y - 1 for the current Y
+    ublas::vector<int> pi; // Workspace for the permutation
+    ublas::vector<size_t> pii; // Workspace for its inverse
+    TruncatedAssignment assignment;
+    std::vector<Real> costs; // The cost matrix of lap(), row by row
+    std::vector<Real*> costRows; // Pointers to its rows
+    ublas::vector<int> row; // Workspace of lap()
 };
 
 #endif
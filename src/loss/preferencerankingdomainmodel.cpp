@@ -1,25 +1,77 @@
 #include "preferencerankingdomainmodel.hpp"
+#include <algorithm>
 #include <cassert>
 
-PreferenceRankingDomainModel::PreferenceRankingDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y):X(X), Y(Y){}
+namespace {
+
+    /**
+     * Orders items by increasing prediction.
+     */
+    class ByIncreasingF {
+    public:
+
+        ByIncreasingF(const cofi::YType& f) : f(f) {
+        }
+
+        bool operator()(const size_t a, const size_t b) const {
+            return f(a, 0) < f(b, 0);
+        }
+
+    private:
+        const cofi::YType& f;
+    };
+
+
+    /**
+     * Adds value at the given level of the Fenwick tree.
+     */
+    inline void add(std::vector<Real>& tree, size_t level, const Real value) {
+        for (++level; level <= tree.size(); level += level & (~level + 1)) {
+            tree[level - 1] += value;
+        }
+    }
+
+
+    /**
+     * @return the sum of the levels [0, end) of the Fenwick tree.
+     */
+    inline Real prefix(const std::vector<Real>& tree, size_t end) {
+        Real result = 0;
+        for (; end > 0; end -= end & (~end + 1)) {
+            result += tree[end - 1];
+        }
+        return result;
+    }
+}
+
+PreferenceRankingDomainModel::PreferenceRankingDomainModel(const cofi::XType& X, const cofi::YType& Y, const bool quadratic):X(X), Y(Y), quadratic(quadratic){}
 PreferenceRankingDomainModel::~PreferenceRankingDomainModel(void){}
 
 void PreferenceRankingDomainModel::ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad){
     assert(w.size1() == grad.size1());
     assert(w.size2() == grad.size2()); // Gradient with respect to f
-    ublas::matrix<Real> g(Y.size1(), 1);
+    g.resize(Y.size1(), 1, false);
     ComputeLossPartGradient(w, loss, g);
     
     // Make gradient with respect to w
     // grad = prod(trans(g), X);
-    grad = prod(trans(X), g);
+    X.multiplyTransposed(g, grad);
 }
 
 
-void PreferenceRankingDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad){
-    const ublas::matrix<Real> f = prod(X, w);
+void PreferenceRankingDomainModel::ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad){
+    X.multiply(w, f);
     grad.clear();
     loss = 0;
+    if (quadratic) {
+        computeQuadratic(loss, grad);
+    } else {
+        computeSorted(loss, grad);
+    }
+}
+
+
+void PreferenceRankingDomainModel::computeQuadratic(Real &loss, cofi::YType& grad){
     for(size_t i=0; i<Y.size1(); i++){
         for (size_t j=0;j<Y.size1();j++){
             if (Y(i, 0) < Y(j, 0)){
@@ -34,7 +86,80 @@ void PreferenceRankingDomainModel::ComputeLossPartGradient(cofi::WType& w, Real
 }
 
 
+/*
+ * The pair (i, j) with Y(i) < Y(j) contributes if 1 + f(i) - f(j) > 0. For
+ * a fixed i, these j are a prefix of the items by increasing f, and that
+ * prefix only grows with f(i). Sweeping i by increasing f, the j of the
+ * prefix are added to Fenwick trees over the rating levels, which yield the
+ * sums over the j rated above i. The same sweep by decreasing f yields the
+ * sums over the i rated below j.
+ */
+void PreferenceRankingDomainModel::computeSorted(Real &loss, cofi::YType& grad){
+    const size_t n = Y.size1();
+    byF.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        byF[i] = i;
+    }
+    std::sort(byF.begin(), byF.end(), ByIncreasingF(f));
 
+    levels.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        levels[i] = Y(i, 0);
+    }
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    level.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        level[i] = std::lower_bound(levels.begin(), levels.end(), Y(i, 0)) - levels.begin();
+    }
+    const size_t nLevels = levels.size();
 
+    // The items i rated below the items j
+    count.assign(nLevels, 0);
+    sumY.assign(nLevels, 0);
+    sumF.assign(nLevels, 0);
+    sumYF.assign(nLevels, 0);
+    Real totalCount = 0, totalY = 0, totalF = 0, totalYF = 0;
+    size_t next = 0;
+    for (size_t a = 0; a < n; a++) {
+        const size_t i = byF[a];
+        while (next < n && 1 + f(i, 0) - f(byF[next], 0) > 0) {
+            const size_t j = byF[next++];
+            add(count, level[j], 1);
+            add(sumY, level[j], Y(j, 0));
+            add(sumF, level[j], f(j, 0));
+            add(sumYF, level[j], Y(j, 0) * f(j, 0));
+            totalCount += 1;
+            totalY += Y(j, 0);
+            totalF += f(j, 0);
+            totalYF += Y(j, 0) * f(j, 0);
+        }
+        // The sums over the levels above the one of i
+        const size_t end = level[i] + 1;
+        const Real c = totalCount - prefix(count, end);
+        if (c == 0) continue;
+        const Real sy = totalY - prefix(sumY, end);
+        const Real sf = totalF - prefix(sumF, end);
+        const Real syf = totalYF - prefix(sumYF, end);
+        // sum_j (Y(j) - Y(i)) * (1 + f(i) - f(j))
+        loss += (sy - Y(i, 0) * c) * (1 + f(i, 0)) - (syf - Y(i, 0) * sf);
+        grad(i, 0) += sy - Y(i, 0) * c;
+    }
 
-
+    // The items j rated above the items i
+    count.assign(nLevels, 0);
+    sumY.assign(nLevels, 0);
+    next = n;
+    for (size_t a = n; a > 0; a--) {
+        const size_t j = byF[a - 1];
+        while (next > 0 && 1 + f(byF[next - 1], 0) - f(j, 0) > 0) {
+            const size_t i = byF[--next];
+            add(count, level[i], 1);
+            add(sumY, level[i], Y(i, 0));
+        }
+        // The sums over the levels below the one of j
+        const Real c = prefix(count, level[j]);
+        if (c == 0) continue;
+        grad(j, 0) -= Y(j, 0) * c - prefix(sumY, level[j]);
+    }
+}
@@ -1,11 +1,18 @@
 #ifndef _PREFERENCERANKINGDOMAINMODEL_HPP_
 #define _PREFERENCERANKINGDOMAINMODEL_HPP_
 
+#include <vector>
+
 #include "cofilossfunction.hpp"
 
 /**
  * PreferenceRanking Loss.
  *
+ * The loss is the hinge loss of all pairs of differently rated items,
+ * weighted by the difference of their ratings. By default, it is computed
+ * in O(n log n) by a sweep over the items sorted by their prediction, which
+ * keeps running sums per rating level in Fenwick trees. The O(n^2) loop
+ * over all pairs computes the same loss and gradient, up to roundoff.
  */
 
 class PreferenceRankingDomainModel : public CofiLossFunction{
@@ -14,20 +21,33 @@ public:
     /**
      * @param X the samples to learn from
      * @param Y the labels for the given samples
+     * @param quadratic whether to loop over all pairs instead of sorting
      */
     
-    PreferenceRankingDomainModel(const ublas::matrix<Real>& X, const ublas::matrix<Real>& Y);
+    PreferenceRankingDomainModel(const cofi::XType& X, const cofi::YType& Y, const bool quadratic = false);
     ~PreferenceRankingDomainModel(void);
 
     void ComputeLossGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
-    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::WType& grad);
+    void ComputeLossPartGradient(cofi::WType& w, Real &loss, cofi::YType& grad);
     
     
     
 private:
+    void computeQuadratic(Real &loss, cofi::YType& grad);
+    void computeSorted(Real &loss, cofi::YType& grad);
+
     // Attributes
-    const ublas::matrix<Real>& X;
-    const ublas::matrix<Real>& Y;
+    const cofi::XType& X;
+    const cofi::YType& Y;
+    const bool quadratic;
+    cofi::YType f; // Workspace for the prediction
+    cofi::YType g; // Workspace for the gradient with respect to f
+
+    // Workspace of computeSorted()
+    std::vector<size_t> byF; // The items by increasing f
+    std::vector<Real> levels; // The distinct ratings, increasing
+    std::vector<size_t> level; // The level of each item
+    std::vector<Real> count, sumY, sumF, sumYF; // The Fenwick trees over the levels
 };
 
 #endif
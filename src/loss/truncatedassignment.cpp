@@ -0,0 +1,146 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "truncatedassignment.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+    /**
+     * Orders items by decreasing score, ties by increasing item.
+     */
+    class ByDecreasingScore {
+    public:
+
+        ByDecreasingScore(const Real* f) : f(f) {
+        }
+
+        bool operator()(const size_t a, const size_t b) const {
+            return f[a] > f[b] || (f[a] == f[b] && a < b);
+        }
+
+    private:
+        const Real* f;
+    };
+}
+
+
+void TruncatedAssignment::solve(const size_t n, const size_t k, const Real* gain, const Real* discount, const Real norm,
+        const Real* c, const Real* f, int* pi) {
+    if (n == 0) {
+        return;
+    }
+    u.assign(n + 1, 0.0);
+    v.assign(n + 1, 0.0);
+    p.assign(n + 1, 0);
+    way.resize(n + 1);
+    minv.resize(n + 1);
+    used.resize(n + 1);
+    order.resize(n);
+    for (size_t j = 0; j < n; ++j) {
+        order[j] = j;
+    }
+    std::sort(order.begin(), order.end(), ByDecreasingScore(f));
+
+    // Row k+r gets the item of rank r. The column duals are a concave
+    // function of f with slope -c[k+r] between the ranks r and r+1, such that
+    // the line of slope -c[k+r] through rank r lies above all of them. This
+    // makes u[k+r] + v[j] <= -c[k+r] * f[j], with equality at rank r.
+    const Real lastC = c[n - 1];
+    for (size_t r = 1; r < n; ++r) {
+        const Real slope = (k + r - 1 < n) ? c[k + r - 1] : lastC;
+        v[order[r] + 1] = v[order[r - 1] + 1] + slope * (f[order[r - 1]] - f[order[r]]);
+    }
+    for (size_t r = 0; k + r < n; ++r) {
+        const size_t row = k + r + 1;
+        const size_t col = order[r] + 1;
+        p[col] = row;
+        u[row] = -c[k + r] * f[order[r]] - v[col];
+    }
+
+    // Add the top rows, one shortest augmenting path each. The loops run on
+    // raw pointers, which keeps them tight in unoptimized builds, too.
+    const Real inf = std::numeric_limits<Real>::max();
+    Real* const us = &u[0];
+    Real* const vs = &v[0];
+    size_t* const ps = &p[0];
+    size_t* const ways = &way[0];
+    Real* const minvs = &minv[0];
+    char* const useds = &used[0];
+    for (size_t i = 1; i <= k; ++i) {
+        ps[0] = i;
+        size_t j0 = 0;
+        std::fill(minv.begin(), minv.end(), inf);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            useds[j0] = 1;
+            const size_t i0 = ps[j0];
+            const size_t row = i0 - 1;
+            const Real ui = us[i0];
+            const Real ci = c[row];
+            Real delta = inf;
+            size_t j1 = 0;
+            if (row < k) {
+                const Real di = discount[row];
+                for (size_t j = 1; j <= n; ++j) {
+                    if (useds[j]) continue;
+                    const Real cur = ((gain[j - 1] / di) / norm - ci * f[j - 1]) - ui - vs[j];
+                    if (cur < minvs[j]) {
+                        minvs[j] = cur;
+                        ways[j] = j0;
+                    }
+                    if (minvs[j] < delta) {
+                        delta = minvs[j];
+                        j1 = j;
+                    }
+                }
+            } else {
+                for (size_t j = 1; j <= n; ++j) {
+                    if (useds[j]) continue;
+                    const Real cur = (0.0 - ci * f[j - 1]) - ui - vs[j];
+                    if (cur < minvs[j]) {
+                        minvs[j] = cur;
+                        ways[j] = j0;
+                    }
+                    if (minvs[j] < delta) {
+                        delta = minvs[j];
+                        j1 = j;
+                    }
+                }
+            }
+            for (size_t j = 0; j <= n; ++j) {
+                if (useds[j]) {
+                    us[ps[j]] += delta;
+                    vs[j] -= delta;
+                } else {
+                    minvs[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (ps[j0] != 0);
+        do {
+            const size_t j1 = ways[j0];
+            ps[j0] = ps[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (size_t j = 1; j <= n; ++j) {
+        pi[p[j] - 1] = static_cast<int> (j - 1);
+    }
+}
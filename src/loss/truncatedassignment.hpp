@@ -0,0 +1,70 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _TRUNCATEDASSIGNMENT_HPP_
+#define _TRUNCATEDASSIGNMENT_HPP_
+
+#include <vector>
+
+#include "core/types.hpp"
+
+/**
+ * Solves the linear assignment problem of the NDCG loss: Find the
+ * permutation pi, with pi[i] the item at position i, minimizing
+ *
+ *   sum_{i<k} (gain[pi[i]] / discount[i]) / norm - sum_{i<n} c[i] * f[pi[i]]
+ *
+ * for a non-increasing c. This is the problem lap() solves on the dense
+ * n x n cost matrix, but only its first k rows are arbitrary: Below k, the
+ * cost -c[i] * f[j] is optimized by placing the remaining items by
+ * decreasing f.
+ *
+ * Hence, the solver starts from that order on the rows k..n-1, leaving the k
+ * items of smallest f free, together with dual variables for it in closed
+ * form. Then, the k top rows are added by one shortest augmenting path each,
+ * as in the Hungarian method. A path costs O(n) per row it visits, which
+ * makes the solver O(n log n + k * n * length of the paths). A path visits
+ * at most n rows, so the worst case is O(k * n^2) time, against O(n^3) for
+ * lap(), in O(n) memory and without forming the cost matrix.
+ */
+class TruncatedAssignment {
+public:
+
+    /**
+     * @param n the number of items and positions.
+     * @param k the number of top positions, at most n.
+     * @param gain the gain of each item, n entries.
+     * @param discount the discount of each top position, k entries.
+     * @param norm the normalization of the top positions.
+     * @param c the non-increasing weights of the positions, n entries.
+     * @param f the scores of the items, n entries.
+     * @param pi the optimal permutation, n entries.
+     */
+    void solve(const size_t n, const size_t k, const Real* gain, const Real* discount, const Real norm,
+            const Real* c, const Real* f, int* pi);
+
+private:
+    // Workspace, indexed from 1 as in the Hungarian method, 0 is the root
+    std::vector<Real> u;        // Dual of the rows
+    std::vector<Real> v;        // Dual of the columns
+    std::vector<size_t> p;      // The row a column is assigned to, 0 if none
+    std::vector<size_t> way;    // The previous column on the shortest path
+    std::vector<Real> minv;     // The distance of the unvisited columns
+    std::vector<char> used;     // Whether a column is on the path tree
+    std::vector<size_t> order;  // The items by decreasing f
+};
+
+#endif /* _TRUNCATEDASSIGNMENT_HPP_ */
@@ -202,13 +202,23 @@ Configuration& Configuration::getInstance(void) {
         // whether or not top use the GraphKernel
         instance->setInt("cofi.useGraphKernel", 0);
 
-        // whether or not U, M and F shall be stored at the end
+        // whether or not the model and the top predictions shall be stored at the end
         instance->setInt("cofi.storeModel", 0);
+        instance->setInt("cofi.storeModel.float", 0);
         instance->setInt("cofi.storeF", 0);
+        instance->setInt("cofi.storeF.k", 10);
+        // use an approximate item index with this many lists for F, 0 scores all items
+        instance->setInt("cofi.storeF.index.lists", 0);
+        instance->setInt("cofi.storeF.index.probes", 8);
 
         // Lambdas
         instance->setDouble("cofi.userphase.lambda", 10.0);
         instance->setDouble("cofi.moviephase.lambda", 10.0);
+        // Solve the REGRESSION user problems in closed form instead of by BMRM
+        instance->setInt("cofi.userphase.direct", 0);
+        // Compute the movie gradient per item from a column index of D
+        // instead of scattering it per user
+        instance->setInt("cofi.moviephase.itemMajor", 0);
 
         // Whether or not to use the sigma based regularizer
         instance->setInt("cofi.useSigmaRegularizer", 0);
@@ -218,9 +228,18 @@ Configuration& Configuration::getInstance(void) {
         instance->setDouble("cofi.adaptiveRegularization.uExponent", 1.0);
         instance->setDouble("cofi.adaptiveRegularization.wExponent", 1.0);
 
-        // Solver Config
+        // Solver Config: BMRM, LBFGS or SUBGRADIENT. The latter two are meant for
+        // the smooth REGRESSION loss only.
         instance->setString("cofi.solver", "BMRM");
 
+        // Number of threads used in the user and movie phase and for loading
+        // the data. 0 means one per processor.
+        instance->setInt("cofi.threads", 1);
+
+        // Whether to keep a binary cache of the train and test data next to
+        // the SVMLight files.
+        instance->setInt("cofibmrm.cacheD", 0);
+
         // Dimension of U and M.
         instance->setInt("cofi.dimW", 10);
 
@@ -245,6 +264,10 @@ Configuration& Configuration::getInstance(void) {
         instance->setInt("cofi.eval.mse", 1);
         instance->setInt("cofi.eval.brmse", 0);
         instance->setInt("cofi.eval.ir", 0);
+        // Snapshots of U and M evaluated in a background thread while the
+        // training continues, at most this many at a time. 0 evaluates
+        // synchronously.
+        instance->setInt("cofi.eval.async", 0);
 
 
 
@@ -256,6 +279,32 @@ Configuration& Configuration::getInstance(void) {
         instance->setInt("bmrm.maxNumberOfIterations", 70);
 
         instance->setString("bmrm.innerSolver", "prLOQO");
+        // Points per problem kept between the iterations of COFIBMRM to warm
+        // start BMRM from, 0 for cold starts
+        instance->setInt("bmrm.warmStartPlanes", 0);
+
+        // The bundle of BMRM. maxBundleMB bounds the memory of the stored
+        // gradients, 0 for no bound; fewer of them are kept to stay below it.
+        instance->setInt("DualInnerSolver.maxGradSetSize", 100);
+        instance->setInt("DualInnerSolver.gradIdleAge", 9);
+        instance->setInt("DualInnerSolver.removeAllIdleGradients", 0);
+        instance->setDouble("DualInnerSolver.maxBundleMB", 0.0);
+        instance->setInt("DualInnerSolver.singlePrecision", 0);
+        instance->setInt("DaiFletcherPGM.maxProjIter", 200);
+        instance->setInt("DaiFletcherPGM.maxPGMIter", 300000);
+        // Use the AVX / AVX-512 kernels in the QP where the CPU has them. Off
+        // by default, as they can change the last bits of the results
+        instance->setInt("DaiFletcherPGM.simd", 0);
+
+        // LBFGS options
+        instance->setInt("lbfgs.memory", 5);
+        instance->setDouble("lbfgs.minRelativeProgress", 1e-4);
+        instance->setInt("lbfgs.maxNumberOfIterations", 100);
+
+        // Subgradient options
+        instance->setDouble("subgradient.initialStepSize", 0.1);
+        instance->setDouble("subgradient.minRelativeProgress", 1e-3);
+        instance->setInt("subgradient.maxNumberOfIterations", 100);
 
         // SGD Options
         instance->setDouble("sgd.minRelativeProgress", 0.01);
@@ -266,6 +315,8 @@ Configuration& Configuration::getInstance(void) {
         // NDCG
         instance->setInt("loss.ndcg.trainK", 10);
         instance->setDouble("loss.ndcg.c_exponent", -0.25);
+        // ORDINAL: 1 loops over all pairs of ratings instead of sorting them
+        instance->setInt("loss.ordinal.quadratic", 0);
         // Weighted SoftMargin Options
         instance->setDouble("loss.weightedSoftMargin.positiveWeight", 1.0);
         instance->setDouble("loss.weightedSoftMargin.negativeWeight", 1.0);
@@ -0,0 +1,208 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "parallel.hpp"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "utils/configuration.hpp"
+#include "core/cofiexception.hpp"
+
+namespace {
+
+    /**
+     * The block of indices currently owned by one worker.
+     *
+     * next and end are guarded by lock, as thieves shrink end concurrently.
+     */
+    struct WorkerRange {
+        pthread_mutex_t lock;
+        size_t next;
+        size_t end;
+    };
+
+    /**
+     * Everything the workers share.
+     */
+    struct Schedule {
+        cofi::parallel::RangeTask* task;
+        size_t grain;
+        std::vector<WorkerRange> ranges;
+
+        pthread_mutex_t errorLock;
+        volatile bool failed;
+        std::string error;
+    };
+
+    struct WorkerArgs {
+        Schedule* schedule;
+        size_t id;
+    };
+
+
+    /**
+     * Claims the next chunk of the own block.
+     *
+     * @return false, if the own block is exhausted.
+     */
+    bool claim(WorkerRange& r, const size_t grain, size_t& begin, size_t& end) {
+        pthread_mutex_lock(&r.lock);
+        begin = r.next;
+        end = std::min(r.end, r.next + grain);
+        r.next = end;
+        pthread_mutex_unlock(&r.lock);
+        return begin < end;
+    }
+
+
+    /**
+     * Steals the upper half of the remaining block of another worker and makes
+     * it the new block of worker id.
+     *
+     * @return false, if there was nothing left to steal.
+     */
+    bool steal(Schedule& s, const size_t id) {
+        const size_t n = s.ranges.size();
+        for (size_t i = 1; i < n; ++i) {
+            WorkerRange& victim = s.ranges[(id + i) % n];
+            pthread_mutex_lock(&victim.lock);
+            const size_t remaining = victim.end - std::min(victim.next, victim.end);
+            if (remaining >= 2) {
+                const size_t mid = victim.end - remaining / 2;
+                const size_t end = victim.end;
+                victim.end = mid;
+                pthread_mutex_unlock(&victim.lock);
+
+                WorkerRange& own = s.ranges[id];
+                pthread_mutex_lock(&own.lock);
+                own.next = mid;
+                own.end = end;
+                pthread_mutex_unlock(&own.lock);
+                return true;
+            }
+            pthread_mutex_unlock(&victim.lock);
+        }
+        return false;
+    }
+
+
+    void fail(Schedule& s, const std::string& message) {
+        pthread_mutex_lock(&s.errorLock);
+        if (!s.failed) {
+            s.error = message;
+            s.failed = true;
+        }
+        pthread_mutex_unlock(&s.errorLock);
+    }
+
+
+    void* work(void* a) {
+        WorkerArgs* args = static_cast<WorkerArgs*> (a);
+        Schedule& s = *(args->schedule);
+        const size_t id = args->id;
+        try {
+            do {
+                size_t begin, end;
+                while (!s.failed && claim(s.ranges[id], s.grain, begin, end)) {
+                    s.task->run(begin, end, id);
+                }
+            } while (!s.failed && steal(s, id));
+        } catch (cofi::CoFiException& e) {
+            fail(s, e.describe());
+        } catch (std::exception& e) {
+            fail(s, e.what());
+        }
+        return NULL;
+    }
+}
+
+
+size_t cofi::parallel::getNumberOfThreads(void) {
+    const int threads = Configuration::getInstance().getInt("cofi.threads");
+    if (threads > 0) {
+        return static_cast<size_t> (threads);
+    }
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? static_cast<size_t> (online) : 1;
+}
+
+
+void cofi::parallel::forEach(RangeTask& task, const size_t n, const size_t nThreads, const size_t grain) {
+    if (n == 0) return;
+    const size_t workers = std::max<size_t > (1, std::min(nThreads, n));
+    if (workers == 1) {
+        task.run(0, n, 0);
+        return;
+    }
+
+    Schedule s;
+    s.task = &task;
+    s.grain = std::max<size_t > (1, grain);
+    s.failed = false;
+    s.ranges.resize(workers);
+    pthread_mutex_init(&s.errorLock, NULL);
+    for (size_t i = 0; i < workers; ++i) {
+        pthread_mutex_init(&s.ranges[i].lock, NULL);
+        s.ranges[i].next = (n * i) / workers;
+        s.ranges[i].end = (n * (i + 1)) / workers;
+    }
+
+    std::vector<WorkerArgs> args(workers);
+    std::vector<pthread_t> threads(workers);
+    size_t started = 1;
+    for (size_t i = 0; i < workers; ++i) {
+        args[i].schedule = &s;
+        args[i].id = i;
+    }
+    for (size_t i = 1; i < workers; ++i) {
+        if (pthread_create(&threads[i], NULL, work, &args[i]) != 0) {
+            // The running workers steal from the blocks of the missing ones,
+            // whatever is left is done below.
+            break;
+        }
+        ++started;
+    }
+    work(&args[0]);
+    for (size_t i = 1; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    // Leftovers of workers that could not be started
+    for (size_t i = started; i < workers && !s.failed; ++i) {
+        if (s.ranges[i].next < s.ranges[i].end) {
+            try {
+                task.run(s.ranges[i].next, s.ranges[i].end, 0);
+            } catch (CoFiException& e) {
+                fail(s, e.describe());
+            } catch (std::exception& e) {
+                fail(s, e.what());
+            }
+        }
+    }
+
+    for (size_t i = 0; i < workers; ++i) {
+        pthread_mutex_destroy(&s.ranges[i].lock);
+    }
+    pthread_mutex_destroy(&s.errorLock);
+
+    if (s.failed) {
+        throw CoFiException("cofi::parallel::forEach(): a worker failed: " + s.error);
+    }
+}
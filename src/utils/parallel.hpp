@@ -0,0 +1,83 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _PARALLEL_HPP_
+#define _PARALLEL_HPP_
+
+#include <cstddef>
+
+namespace cofi {
+    namespace parallel {
+
+        /**
+         * A piece of work that can be split over an index range [0, n).
+         *
+         * Implementations must be safe to call concurrently for disjoint
+         * ranges. The thread id passed to run() is in [0, nThreads) and can be
+         * used to index per-thread workspaces.
+         */
+        class RangeTask {
+        public:
+
+
+            virtual ~RangeTask(void) {
+            }
+
+            /**
+             * Processes the indices [begin, end).
+             *
+             * @param begin the first index to process (inclusive)
+             * @param end the last index to process (exclusive)
+             * @param thread the id of the worker thread calling.
+             */
+            virtual void run(const size_t begin, const size_t end, const size_t thread) = 0;
+        };
+
+
+        /**
+         * @return the number of worker threads as configured by cofi.threads.
+         *         A value of 0 or less in the configuration means "one thread
+         *         per online processor".
+         */
+        size_t getNumberOfThreads(void);
+
+
+        /**
+         * Runs the given task over [0, n) using nThreads worker threads.
+         *
+         * The range is initially split into nThreads contiguous blocks. Each
+         * worker processes its own block in chunks of size grain. A worker
+         * that runs out of work steals the upper half of the remaining block
+         * of another worker. This keeps the load balanced even if the cost per
+         * index is very skewed.
+         *
+         * The calling thread acts as worker 0. With nThreads <= 1, the task is
+         * simply run on the whole range in the calling thread.
+         *
+         * If a worker throws, the remaining work is abandoned and a
+         * CoFiException describing the first error is thrown in the calling
+         * thread once all workers have finished.
+         *
+         * @param task the task to run.
+         * @param n the size of the index range.
+         * @param nThreads the number of workers to use.
+         * @param grain the number of indices a worker claims at once.
+         */
+        void forEach(RangeTask& task, const size_t n, const size_t nThreads, const size_t grain = 1);
+
+    }
+}
+#endif /* _PARALLEL_HPP_ */
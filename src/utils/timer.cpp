@@ -22,6 +22,8 @@
 
 #include "timer.hpp"
 
+#include <sys/time.h>
+
 CTimer::CTimer():n(0),
                  max_time(0),
                  min_time(99999999),
@@ -75,4 +77,11 @@ double CTimer::Total()
   return total_time;
 }
 
+double WallClock()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
 #endif
@@ -50,4 +50,11 @@ public:
   
 };
 
+
+/** @return the wall clock time in seconds. Unlike the cpu-seconds of CTimer,
+ *          differences of it are meaningful within a thread when several
+ *          threads are running.
+ */
+double WallClock();
+
 #endif
@@ -0,0 +1,105 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Checks that the SIMD kernels of DaiFletcherPGM give the results of the
+ * scalar ones.
+ *
+ * Usage: daifletcherpgmtest [USERS]
+ *
+ * Solves the ORDINAL problems of USERS random users by BMRM, once with
+ * DaiFletcherPGM.simd 0 and once with 1, and compares the solutions and
+ * their objectives. The vector kernels only change the order of summation,
+ * but that can take BMRM along other cutting planes, so the runs need not
+ * stop at the same w. Both must be within epsilon of the optimum, though:
+ * their objectives agree to epsilon and, as the objective is lambda-strongly
+ * convex, the solutions to 2 sqrt(2 epsilon / lambda). On CPUs without AVX,
+ * both runs use the scalar kernels.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "core/types.hpp"
+#include "bmrm/solver/daifletcherpgm.hpp"
+#include "cofi/solver.hpp"
+#include "loss/preferencerankingdomainmodel.hpp"
+#include "testutils.hpp"
+
+namespace {
+
+    Real objective(PreferenceRankingDomainModel& model, const cofi::WType& w, const Real lambda) {
+        cofi::WType v(w);
+        cofi::WType grad(w.size1(), 1);
+        Real loss = 0;
+        model.ComputeLossGradient(v, loss, grad);
+        Real norm = 0;
+        for (size_t j = 0; j < w.size1(); ++j) {
+            norm += w(j, 0) * w(j, 0);
+        }
+        return lambda / 2 * norm + loss;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nUsers = argc > 1 ? atoi(argv[1]) : 100;
+    const size_t dim = 10;
+    const Real lambda = 10.0;
+    const Real epsilonTol = 1e-12;
+    const Real relEpsilonTol = 1e-6;
+
+    DualInnerSolverSettings scalarSettings;
+    scalarSettings.simd = false;
+    DualInnerSolverSettings simdSettings;
+    simdSettings.simd = true;
+    std::cout << "Comparing the " << DaiFletcherPGM(lambda, simdSettings).KernelName() << " kernels with the "
+            << DaiFletcherPGM(lambda, scalarSettings).KernelName() << " ones" << std::endl;
+    cofi::Solver scalar(0, epsilonTol, 0, relEpsilonTol, 1000, scalarSettings);
+    cofi::Solver simd(0, epsilonTol, 0, relEpsilonTol, 1000, simdSettings);
+
+    srand(1);
+    size_t nFailed = 0;
+    for (size_t user = 0; user < nUsers; ++user) {
+        const size_t n = 2 + rand() % 50;
+        cofi::tests::RandomUser u(n, dim, n, 5);
+        PreferenceRankingDomainModel model(u.X, u.Y);
+
+        cofi::WType scalarW(dim, 1);
+        scalarW.clear();
+        scalar.optimize(scalarW, model, lambda, 0);
+        cofi::WType simdW(dim, 1);
+        simdW.clear();
+        simd.optimize(simdW, model, lambda, 0);
+
+        const Real scalarObjective = objective(model, scalarW, lambda);
+        const Real simdObjective = objective(model, simdW, lambda);
+        const Real epsilon = std::max(relEpsilonTol * std::max(scalarObjective, simdObjective), epsilonTol);
+        Real distance = 0;
+        for (size_t j = 0; j < dim; ++j) {
+            distance += (scalarW(j, 0) - simdW(j, 0)) * (scalarW(j, 0) - simdW(j, 0));
+        }
+        if (!(fabs(scalarObjective - simdObjective) <= epsilon) || !(sqrt(distance) <= 2 * sqrt(2 * epsilon / lambda))) {
+            std::cout << "ERROR: user " << user << " with " << n << " ratings: objective " << simdObjective
+                    << " instead of " << scalarObjective << ", distance of the solutions " << sqrt(distance) << std::endl;
+            ++nFailed;
+        }
+    }
+    std::cout << nUsers - nFailed << " of " << nUsers << " users agree" << std::endl;
+    return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Checks the direct solve of the least squares user problem against BMRM.
+ *
+ * Usage: leastsquaretest [USERS]
+ *
+ * Solves the problems of USERS random users both with
+ * LeastSquareDomainModel::solve() and with BMRM on UserLoss, as the user
+ * phase does, and compares their objectives lambda/2 |w|^2 + weight * loss(w).
+ * The direct solution must not be worse and BMRM must come close to it. The
+ * users have between 1 and 3 dimW ratings, hence many have fewer ratings than
+ * dimW, with and without the movie offset and with and without a weight.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "core/types.hpp"
+#include "cofi/solver.hpp"
+#include "loss/leastsquaredomainmodel.hpp"
+#include "loss/userloss.hpp"
+#include "testutils.hpp"
+
+namespace {
+
+    /**
+     * @return lambda/2 |w|^2 + weight * loss(w), with the offset handled as
+     *         by UserLoss.
+     */
+    Real objective(cofi::UserLoss& loss, const cofi::WType& w, const Real lambda, const Real weight) {
+        cofi::WType v(w);
+        cofi::WType grad(w.size1(), 1);
+        Real value = 0;
+        loss.ComputeLossGradient(v, value, grad);
+        Real norm = 0;
+        for (size_t j = 0; j < w.size1(); ++j) {
+            norm += w(j, 0) * w(j, 0);
+        }
+        return lambda / 2 * norm + weight * value;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nUsers = argc > 1 ? atoi(argv[1]) : 300;
+    const size_t dim = 10;
+    const Real lambda = 10.0;
+
+    srand(1);
+    // Run BMRM until the relative gap of the objective is below 1e-9
+    cofi::Solver solver(0, 0, 0, 1e-9, 10000);
+    size_t nFailed = 0;
+    size_t nFewer = 0;
+    for (size_t user = 0; user < nUsers; ++user) {
+        const size_t n = 1 + rand() % (3 * dim);
+        nFewer += n < dim ? 1 : 0;
+        const bool useOffset = user % 2 == 0;
+        const Real weight = user % 4 < 2 ? 1.0 : 0.1 + 2.0 * rand() / RAND_MAX;
+
+        cofi::tests::RandomUser u(n, dim, n, 5);
+        LeastSquareDomainModel model(u.X, u.Y);
+        cofi::UserLoss loss(model, useOffset);
+
+        cofi::WType direct(dim, 1);
+        model.solve(direct, lambda, weight, useOffset ? cofi::MOVIE_OFFSET_COLUMN : dim);
+        // lambda/2 |w|^2 + weight * loss(w) has the minimizer of
+        // lambda/weight/2 |w|^2 + loss(w)
+        cofi::WType bmrm(dim, 1);
+        bmrm.clear();
+        solver.optimize(bmrm, loss, lambda / weight, 0);
+
+        const Real directObjective = objective(loss, direct, lambda, weight);
+        const Real bmrmObjective = objective(loss, bmrm, lambda, weight);
+        if (!(directObjective <= bmrmObjective * (1 + 1e-12)) || !(bmrmObjective - directObjective <= 1e-6 * directObjective)) {
+            std::cout << "ERROR: user " << user << " with " << n << " ratings" << (useOffset ? ", offset" : "")
+                    << ", weight " << weight << ": direct objective " << directObjective
+                    << ", BMRM objective " << bmrmObjective << std::endl;
+            ++nFailed;
+        }
+    }
+    std::cout << nUsers - nFailed << " of " << nUsers << " users agree with BMRM, " << nFewer
+            << " of them with fewer ratings than dimW" << std::endl;
+    return nFailed == 0 ? 0 : 1;
+}
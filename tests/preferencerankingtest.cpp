@@ -0,0 +1,80 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Checks the sorted ORDINAL loss against the loop over all pairs.
+ *
+ * Usage: preferencerankingtest [USERS]
+ *
+ * Computes the loss and the gradient of PreferenceRankingDomainModel for
+ * USERS random users both ways and compares them. The ratings are drawn from
+ * a few levels, and some items share their features and hence their scores,
+ * so both ties in y and in f occur.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "core/types.hpp"
+#include "loss/preferencerankingdomainmodel.hpp"
+#include "testutils.hpp"
+
+namespace {
+
+    bool close(const Real a, const Real b) {
+        return fabs(a - b) <= 1e-9 * (1 + fabs(a));
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nUsers = argc > 1 ? atoi(argv[1]) : 1000;
+    const size_t dim = 5;
+
+    srand(1);
+    size_t nFailed = 0;
+    for (size_t user = 0; user < nUsers; ++user) {
+        const size_t n = 1 + rand() % 200;
+        const size_t nSources = 1 + rand() % n;
+        const size_t nLevels = 1 + rand() % 5;
+        cofi::tests::RandomUser u(n, dim, nSources, nLevels);
+        cofi::WType w(dim, 1);
+        for (size_t j = 0; j < dim; ++j) {
+            w(j, 0) = 0.5 * cofi::tests::uniform();
+        }
+
+        PreferenceRankingDomainModel sorted(u.X, u.Y, false);
+        PreferenceRankingDomainModel quadratic(u.X, u.Y, true);
+        Real sortedLoss, quadraticLoss;
+        cofi::YType sortedGrad(n, 1);
+        cofi::YType quadraticGrad(n, 1);
+        sorted.ComputeLossPartGradient(w, sortedLoss, sortedGrad);
+        quadratic.ComputeLossPartGradient(w, quadraticLoss, quadraticGrad);
+
+        bool same = close(quadraticLoss, sortedLoss);
+        for (size_t i = 0; i < n; ++i) {
+            same = same && close(quadraticGrad(i, 0), sortedGrad(i, 0));
+        }
+        if (!same) {
+            std::cout << "ERROR: user " << user << " with " << n << " ratings: loss " << sortedLoss
+                    << " instead of " << quadraticLoss << " or a different gradient" << std::endl;
+            ++nFailed;
+        }
+    }
+    std::cout << nUsers - nFailed << " of " << nUsers << " users agree with the loop over all pairs" << std::endl;
+    return nFailed == 0 ? 0 : 1;
+}
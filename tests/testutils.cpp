@@ -0,0 +1,40 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#include "testutils.hpp"
+
+#include <cstdlib>
+
+
+Real cofi::tests::uniform(void) {
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+
+cofi::tests::RandomUser::RandomUser(const size_t n, const size_t dim, const size_t nSources, const size_t nLevels) :
+M(nSources, dim), Y(n, 1) {
+    for (size_t i = 0; i < nSources; ++i) {
+        for (size_t j = 0; j < dim; ++j) {
+            M(i, j) = uniform();
+        }
+    }
+    X.setSource(M);
+    X.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        X.setIndex(i, nSources < n ? rand() % nSources : i);
+        Y(i, 0) = 1 + rand() % nLevels;
+    }
+}
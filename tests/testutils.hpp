@@ -0,0 +1,58 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+#ifndef _TESTUTILS_HPP_
+#define _TESTUTILS_HPP_
+
+#include "core/types.hpp"
+
+namespace cofi {
+
+    /**
+     * Helpers shared by the test drivers in tests/.
+     */
+    namespace tests {
+
+        /**
+         * @return a number drawn uniformly from [-1, 1] by rand().
+         */
+        Real uniform(void);
+
+
+        /**
+         * The problem of a random user: n ratings in 1 ... nLevels of items
+         * with dim features drawn by uniform().
+         *
+         * The features are the nSources rows of M. With nSources < n, every
+         * item takes a random row, so that several share their features and
+         * hence their scores; otherwise, item i takes row i.
+         */
+        class RandomUser {
+        public:
+            RandomUser(const size_t n, const size_t dim, const size_t nSources, const size_t nLevels);
+
+            ublas::matrix<double> M;
+            cofi::XType X;
+            cofi::YType Y;
+
+        private:
+            // Not implemented, X refers to M.
+            RandomUser(const RandomUser& other);
+            RandomUser& operator=(const RandomUser& other);
+        };
+    }
+}
+#endif /* _TESTUTILS_HPP_ */
@@ -0,0 +1,137 @@
+/* The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Authors      : Markus Weimer       (cofirank@weimo.de)
+ *
+ * Created      : 17/10/2026
+ *
+ * Last Updated :
+ */
+
+/**
+ * Checks TruncatedAssignment against lap() on the dense cost matrix.
+ *
+ * Usage: truncatedassignmenttest [PROBLEMS]
+ *
+ * Solves PROBLEMS random assignment problems of the NDCG loss with both and
+ * compares the costs of the permutations found, which must agree up to
+ * rounding. Half of the problems have k = n, the largest k the NDCG loss
+ * allows, the others a random k. Half of them draw the gains, weights and
+ * scores from a few values, hence with ties.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "core/types.hpp"
+#include "loss/lap.hpp"
+#include "loss/truncatedassignment.hpp"
+
+namespace {
+
+    struct Problem {
+        size_t n;
+        size_t k;
+        std::vector<Real> gain;
+        std::vector<Real> discount;
+        Real norm;
+        std::vector<Real> c;
+        std::vector<Real> f;
+    };
+
+
+    void randomProblem(const size_t n, const size_t k, const bool ties, Problem& p) {
+        p.n = n;
+        p.k = k;
+        p.gain.resize(n);
+        p.f.resize(n);
+        for (size_t j = 0; j < n; ++j) {
+            p.gain[j] = ties ? rand() % 3 : rand() / (Real) RAND_MAX;
+            p.f[j] = ties ? rand() % 4 - 2.0 : 2.0 * rand() / RAND_MAX - 1.0;
+        }
+        p.discount.resize(k);
+        p.norm = 0;
+        for (size_t i = 0; i < k; ++i) {
+            p.discount[i] = log(i + 2.0) / log(2.0);
+            p.norm += 1.0 / p.discount[i];
+        }
+        // Non-increasing, with runs of equal weights if ties
+        p.c.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            p.c[i] = ties ? 1.0 / (1 + i / 3) : 1.0 / sqrt(i + 1.0);
+        }
+    }
+
+
+    Real cost(const Problem& p, const size_t i, const size_t j) {
+        return (i < p.k ? (p.gain[j] / p.discount[i]) / p.norm : 0) - p.c[i] * p.f[j];
+    }
+
+
+    /**
+     * @return the cost of pi, or NaN if it is no permutation.
+     */
+    Real total(const Problem& p, const std::vector<int>& pi) {
+        std::vector<char> seen(p.n, 0);
+        Real result = 0;
+        for (size_t i = 0; i < p.n; ++i) {
+            if (pi[i] < 0 || pi[i] >= (int) p.n || seen[pi[i]]) return NAN;
+            seen[pi[i]] = 1;
+            result += cost(p, i, pi[i]);
+        }
+        return result;
+    }
+
+
+    Real solveLap(const Problem& p) {
+        std::vector<Real> costs(p.n * p.n);
+        std::vector<Real*> rows(p.n);
+        for (size_t i = 0; i < p.n; ++i) {
+            rows[i] = &costs[i * p.n];
+            for (size_t j = 0; j < p.n; ++j) {
+                rows[i][j] = cost(p, i, j);
+            }
+        }
+        std::vector<int> pi(p.n);
+        std::vector<int> row(p.n);
+        lap(p.n, &rows[0], &pi[0], &row[0]);
+        return total(p, pi);
+    }
+}
+
+
+int main(int argc, char** argv) {
+    const size_t nProblems = argc > 1 ? atoi(argv[1]) : 2000;
+
+    srand(1);
+    TruncatedAssignment assignment;
+    Problem p;
+    std::vector<int> pi;
+    size_t nFailed = 0;
+    for (size_t t = 0; t < nProblems; ++t) {
+        const size_t n = 1 + rand() % 40;
+        const size_t k = t % 4 < 2 ? n : 1 + rand() % n;
+        const bool ties = t % 2 == 0;
+        randomProblem(n, k, ties, p);
+
+        pi.assign(n, -1);
+        assignment.solve(n, k, &p.gain[0], &p.discount[0], p.norm, &p.c[0], &p.f[0], &pi[0]);
+        const Real truncated = total(p, pi);
+        const Real exact = solveLap(p);
+        if (!(fabs(truncated - exact) <= 1e-9 * (1 + fabs(exact)))) {
+            std::cout << "ERROR: n=" << n << " k=" << k << (ties ? " with ties" : "")
+                    << ": TruncatedAssignment " << truncated << ", lap() " << exact << std::endl;
+            ++nFailed;
+        }
+    }
+    std::cout << nProblems - nFailed << " of " << nProblems << " problems agree with lap()" << std::endl;
+    return nFailed == 0 ? 0 : 1;
+}